@@ -0,0 +1,191 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+/*
+ * Measures the cost of parsing a DataFrame response the way the streaming call data do, comparing heap messages
+ * reused between reads (ReadAheadBuffer) with messages parsed into per-slot arenas (ArenaReadAheadBuffer).
+ *
+ * Usage: ommo_sdk_parse_benchmark [device_count] [iterations]
+ *
+ * Every parse goes through the read-ahead buffer of its variant, so each slot is parsed into on every other
+ * iteration like it is on a live stream. No service is required.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ommo_service_api.pb.h"
+#include "read_ahead_buffer.h"
+
+namespace
+{
+    // Number of heap allocations made through operator new
+    std::atomic<int64_t> allocation_count{ 0 };
+}
+
+void* operator new(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    constexpr int sensor_units_per_device = 4;
+
+    // Build a frame with the fields a full fusion request with raw sensor data returns
+    ommo::DataFrame MakeDataFrame(int device_count)
+    {
+        ommo::DataFrame frame;
+        for (int device = 0; device < device_count; device++)
+        {
+            ommo::TrackingDeviceData* data = frame.add_device_data();
+            data->set_siu_uuid(0x10000 + device / 8);
+            data->set_port_id(device % 8);
+            data->set_timestamp(123456789u + device);
+            for (int unit = 0; unit < sensor_units_per_device; unit++)
+            {
+                ommo::RawSensorData* raw = data->add_raw_sensor_data();
+                for (ommo::Vector3i* vector : { raw->mutable_mag(), raw->mutable_gyro(), raw->mutable_accel() })
+                {
+                    vector->set_x(1000 + unit);
+                    vector->set_y(-2000 - unit);
+                    vector->set_z(3000 + unit);
+                }
+
+                ommo::Vector3f* position = data->add_positions();
+                position->set_x(0.1f * unit);
+                position->set_y(0.2f * unit);
+                position->set_z(0.3f * unit);
+
+                ommo::Vector4f* quaternion = data->add_quaternions();
+                quaternion->set_w(1.0f);
+                quaternion->set_x(0.01f * unit);
+                quaternion->set_y(0.02f * unit);
+                quaternion->set_z(0.03f * unit);
+
+                data->add_indicator_values(0.5f);
+                data->add_motion_indicators(0.25f);
+                data->add_bad_data_indicators(0.0f);
+            }
+            data->add_buttons(ommo::BUTTON_STATE_IDLE);
+            data->add_buttons(ommo::BUTTON_STATE_UP);
+            for (int i = 0; i < 3; i++)
+            {
+                ommo::LatencyTimestampData* latency = data->add_latency_timestamps();
+                latency->set_steady_timestamp_milliseconds(1000000u + i);
+                latency->set_system_timestamp_milliseconds(1700000000000u + i);
+            }
+            data->mutable_battery_state()->set_state_of_charge(80);
+        }
+        return frame;
+    }
+
+    // Parse the payload into read-ahead slots of <buffer>. Returns the time of each parse in nanoseconds and adds
+    // the heap allocations made while parsing to <allocations>.
+    template <typename Buffer>
+    std::vector<int64_t> MeasureParse(Buffer& buffer, const std::string& payload, int iterations, int64_t& allocations)
+    {
+        std::vector<int64_t> samples;
+        samples.reserve(iterations);
+        size_t device_count = 0;
+        const int64_t allocations_before = allocation_count.load();
+        for (int i = 0; i < iterations; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            ommo::DataFrame* slot = buffer.NextReadSlot();
+            slot->ParseFromString(payload);
+            const ommo::DataFrame& received = buffer.CompleteRead();
+            auto end = std::chrono::steady_clock::now();
+
+            // Touch the result so the parse cannot be optimized away
+            device_count += received.device_data_size();
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+        // The samples vector was reserved up front, so only the parses allocate in the loop
+        allocations += allocation_count.load() - allocations_before;
+        if (device_count == 0)
+        {
+            std::printf("Parsed frames are empty\n");
+        }
+        return samples;
+    }
+
+    void PrintResult(const char* name, std::vector<int64_t>& samples, int64_t allocations)
+    {
+        std::sort(samples.begin(), samples.end());
+        int64_t total = 0;
+        for (int64_t sample : samples)
+        {
+            total += sample;
+        }
+        const double to_us = 1.0 / 1000.0;
+        std::printf("%-24s mean %8.2f us  p50 %8.2f us  p99 %8.2f us  allocations/parse %8.2f\n",
+            name,
+            total * to_us / samples.size(),
+            samples[samples.size() / 2] * to_us,
+            samples[std::min(samples.size() - 1, samples.size() * 99 / 100)] * to_us,
+            static_cast<double>(allocations) / samples.size());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int device_count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 32;
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10000;
+
+    const std::string payload = MakeDataFrame(device_count).SerializeAsString();
+
+    ommo::ReadAheadBuffer<ommo::DataFrame> reused_buffer;
+    ommo::ArenaReadAheadBuffer<ommo::DataFrame> arena_buffer;
+
+    // Warm up both buffers so the reused messages have grown to the frame size before measuring
+    int64_t warm_up_allocations = 0;
+    MeasureParse(reused_buffer, payload, 100, warm_up_allocations);
+    MeasureParse(arena_buffer, payload, 100, warm_up_allocations);
+
+    // Alternate between the variants in batches so both see the same machine conditions
+    constexpr int batch_size = 1000;
+    std::vector<int64_t> reused_samples;
+    std::vector<int64_t> arena_samples;
+    int64_t reused_allocations = 0;
+    int64_t arena_allocations = 0;
+    for (int done = 0; done < iterations; done += batch_size)
+    {
+        const int count = std::min(batch_size, iterations - done);
+        std::vector<int64_t> reused_batch = MeasureParse(reused_buffer, payload, count, reused_allocations);
+        std::vector<int64_t> arena_batch = MeasureParse(arena_buffer, payload, count, arena_allocations);
+        reused_samples.insert(reused_samples.end(), reused_batch.begin(), reused_batch.end());
+        arena_samples.insert(arena_samples.end(), arena_batch.begin(), arena_batch.end());
+    }
+
+    std::printf("DataFrame parse over %d iterations (%d devices, %zu bytes)\n", iterations, device_count, payload.size());
+    PrintResult("Reused message", reused_samples, reused_allocations);
+    PrintResult("Arena per slot", arena_samples, arena_allocations);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+/*
+ * Measures the client side cost of opening a device data stream when a new CoreService stub is created for
+ * every stream compared to sharing one stub for the channel.
+ *
+ * Usage: ommo_sdk_stub_benchmark [server_address] [iterations]
+ *
+ * Two times are reported per variant. The open time covers stub creation (when applicable), preparing the call and
+ * StartCall. The cycle time additionally covers cancelling and finishing the stream and releasing the call, the
+ * client context and the stub, so it includes the stub destruction the open time leaves out. Streams are cancelled
+ * right away, so a running service is not required. Both variants share one channel, created once before measuring.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "grpcpp/grpcpp.h"
+#include "ommo_service_api.grpc.pb.h"
+
+namespace
+{
+    void* const start_tag = reinterpret_cast<void*>(1);
+    void* const finish_tag = reinterpret_cast<void*>(2);
+
+    // Wait until the given tag is returned by the completion queue
+    void WaitForTag(grpc::CompletionQueue& cq, void* expected_tag)
+    {
+        void* tag;
+        bool ok;
+        while (cq.Next(&tag, &ok) && tag != expected_tag)
+        {
+        }
+    }
+
+    // Times of one stream in nanoseconds
+    struct StreamTimes
+    {
+        // Until the call is started
+        int64_t open;
+        // Until the stream is finished and everything created for it is released
+        int64_t cycle;
+    };
+
+    // Open a device data stream with the stub returned by get_stub, then cancel it and release it again
+    StreamTimes OpenStream(grpc::CompletionQueue& cq, const std::function<std::shared_ptr<ommo::CoreService::Stub>()>& get_stub)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point opened;
+        {
+            ommo::TrackingDeviceDataStreamRequest request;
+            grpc::ClientContext context;
+            std::shared_ptr<ommo::CoreService::Stub> stub = get_stub();
+            auto reader = stub->PrepareAsyncOpenTrackingDeviceDataStream(&context, request, &cq);
+            reader->StartCall(start_tag);
+            opened = std::chrono::steady_clock::now();
+
+            context.TryCancel();
+            WaitForTag(cq, start_tag);
+            grpc::Status status;
+            reader->Finish(&status, finish_tag);
+            WaitForTag(cq, finish_tag);
+            // The reader, the context and a stub created for this stream are released when leaving the scope
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        return StreamTimes{ std::chrono::duration_cast<std::chrono::nanoseconds>(opened - start).count(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() };
+    }
+
+    void PrintResult(const char* name, std::vector<int64_t>& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        int64_t total = 0;
+        for (int64_t sample : samples)
+        {
+            total += sample;
+        }
+        const double to_us = 1.0 / 1000.0;
+        std::printf("%-24s mean %8.2f us  p50 %8.2f us  p99 %8.2f us\n",
+            name,
+            total * to_us / samples.size(),
+            samples[samples.size() / 2] * to_us,
+            samples[std::min(samples.size() - 1, samples.size() * 99 / 100)] * to_us);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::string server_address = argc > 1 ? argv[1] : "localhost:50051";
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000;
+
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials());
+    grpc::CompletionQueue cq;
+
+    std::shared_ptr<ommo::CoreService::Stub> shared_stub = ommo::CoreService::NewStub(channel);
+    auto new_stub_per_stream = [&channel]() { return std::shared_ptr<ommo::CoreService::Stub>(ommo::CoreService::NewStub(channel)); };
+    auto reuse_shared_stub = [&shared_stub]() { return shared_stub; };
+
+    std::vector<int64_t> new_stub_open_samples;
+    std::vector<int64_t> new_stub_cycle_samples;
+    std::vector<int64_t> shared_stub_open_samples;
+    std::vector<int64_t> shared_stub_cycle_samples;
+    for (std::vector<int64_t>* samples : { &new_stub_open_samples, &new_stub_cycle_samples, &shared_stub_open_samples, &shared_stub_cycle_samples })
+    {
+        samples->reserve(iterations);
+    }
+
+    // Warm up the channel and allocator before measuring
+    for (int i = 0; i < 100; i++)
+    {
+        OpenStream(cq, reuse_shared_stub);
+    }
+
+    // Interleave both variants so they see the same channel conditions
+    for (int i = 0; i < iterations; i++)
+    {
+        const StreamTimes new_stub_times = OpenStream(cq, new_stub_per_stream);
+        new_stub_open_samples.push_back(new_stub_times.open);
+        new_stub_cycle_samples.push_back(new_stub_times.cycle);
+        const StreamTimes shared_stub_times = OpenStream(cq, reuse_shared_stub);
+        shared_stub_open_samples.push_back(shared_stub_times.open);
+        shared_stub_cycle_samples.push_back(shared_stub_times.cycle);
+    }
+
+    std::printf("Stream latency over %d iterations (%s)\n", iterations, server_address.c_str());
+    std::printf("Open: stub creation, prepare and StartCall. Excludes stream teardown and stub destruction.\n");
+    PrintResult("NewStub per stream", new_stub_open_samples);
+    PrintResult("Shared stub", shared_stub_open_samples);
+    std::printf("Full cycle: open, cancel, finish and release of call, context and stub. The channel is created once.\n");
+    PrintResult("NewStub per stream", new_stub_cycle_samples);
+    PrintResult("Shared stub", shared_stub_cycle_samples);
+
+    cq.Shutdown();
+    void* tag;
+    bool ok;
+    while (cq.Next(&tag, &ok))
+    {
+    }
+    return 0;
+}
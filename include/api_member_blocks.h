@@ -0,0 +1,50 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include "sdk_types.h"
+#include "slab_pool.h"
+
+/*
+ * Layout of the member arrays of the api structs inside a PooledArrayBlock.
+ *
+ * The arrays of a struct are placed in declaration order, matching the order the Destroy*Members functions pass them
+ * to DeletePooledArrayBlock. Only the counts of the arrays are known here, the caller sets the count members and fills
+ * the arrays.
+ */
+namespace ommo
+{
+    inline void ReserveTrackingDeviceDataMembers(PooledArrayBlock& block, uint32_t raw_sensor_data_count, uint32_t pose_count, uint32_t button_count, uint32_t latency_timestamp_count)
+    {
+        block.Reserve<api::RawSensorData>(raw_sensor_data_count);
+        block.Reserve<api::PoseData>(pose_count);
+        block.Reserve<api::ButtonState>(button_count);
+        block.Reserve<api::TimestampData>(latency_timestamp_count);
+    }
+
+    inline void PlaceTrackingDeviceDataMembers(PooledArrayBlock& block, api::TrackingDeviceData& data, uint32_t raw_sensor_data_count, uint32_t pose_count, uint32_t button_count, uint32_t latency_timestamp_count)
+    {
+        data.raw_sensor_data = block.Place<api::RawSensorData>(raw_sensor_data_count);
+        data.poses = block.Place<api::PoseData>(pose_count);
+        data.buttons = block.Place<api::ButtonState>(button_count);
+        data.latency_timestamps = block.Place<api::TimestampData>(latency_timestamp_count);
+    }
+
+    inline void ReserveDeviceDescriptorMembers(PooledArrayBlock& block, uint32_t sensor_unit_descriptor_count, uint32_t supported_fusion_modes_count)
+    {
+        block.Reserve<api::SensorUnitDescriptor>(sensor_unit_descriptor_count);
+        block.Reserve<api::DeviceFusionMode>(supported_fusion_modes_count);
+    }
+
+    inline void PlaceDeviceDescriptorMembers(PooledArrayBlock& block, api::DeviceDescriptor& descriptor, uint32_t sensor_unit_descriptor_count, uint32_t supported_fusion_modes_count)
+    {
+        descriptor.sensor_unit_descriptors = block.Place<api::SensorUnitDescriptor>(sensor_unit_descriptor_count);
+        descriptor.supported_fusion_modes = block.Place<api::DeviceFusionMode>(supported_fusion_modes_count);
+    }
+}  // namespace ommo
@@ -28,6 +28,9 @@ namespace ommo
 
         void SwitchBufferPointer();
 
+        // Packet <position> of the packets stored in the read buffer followed by the write buffer. Requires switch_mutex_.
+        const api::BaseStationPacket& GetStoredPacket(int32_t position, int32_t read_packet_num) const;
+
         uint32_t buffer_size_;
 
         // Record the packet index.
@@ -60,6 +63,11 @@ namespace ommo
         // Return all packets starting from start_idx;
         api::BaseStationDataResponseUPtr GetDataSinceIndex(uint32_t start_idx);
 
+        // Buffer variants of the functions above. They copy into the caller owned buffer and do not allocate.
+        // GetLatestData keeps the newest packets and GetDataSinceIndex the oldest ones if the buffer is too small.
+        api::DataResponseState GetLatestData(uint32_t count, api::BaseStationPacketBuffer& buffer);
+        api::DataResponseState GetDataSinceIndex(uint32_t start_idx, api::BaseStationPacketBuffer& buffer);
+
         void SetDataStream(rpcClientCallData* call_data);
         void RemoveDataStream();
         void CancelDataStream();
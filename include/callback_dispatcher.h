@@ -0,0 +1,187 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.h"
+
+namespace ommo
+{
+    /*
+     * Runs a handler for queued items on a dedicated executor thread.
+     *
+     * Items are queued on lanes. Each lane is a bounded SPSC queue that must only be fed by a single producer,
+     * which keeps the producer side lock-free. Items within a lane are handled in order. When a lane is full the
+     * new item is dropped and counted instead of blocking the producer.
+     */
+    template <typename T>
+    class CallbackDispatcher
+    {
+    public:
+        using Lane = SpscQueue<T>;
+
+        CallbackDispatcher(std::function<void(T&)> handler, size_t lane_capacity)
+            : handler_(std::move(handler)), lane_capacity_(lane_capacity)
+        {
+            executor_thread_ = std::thread(&CallbackDispatcher::Run, this);
+        }
+
+        ~CallbackDispatcher()
+        {
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                stop_ = true;
+            }
+            wake_cv_.notify_one();
+            if (executor_thread_.joinable())
+            {
+                executor_thread_.join();
+            }
+        }
+
+        CallbackDispatcher(const CallbackDispatcher&) = delete;
+        CallbackDispatcher& operator=(const CallbackDispatcher&) = delete;
+
+        // Create a new lane. The returned lane must only be fed by one producer thread at a time.
+        std::shared_ptr<Lane> AddLane()
+        {
+            std::shared_ptr<Lane> lane = std::make_shared<Lane>(lane_capacity_);
+            std::lock_guard<std::mutex> lock(lanes_mutex_);
+            lanes_.push_back(lane);
+            lanes_version_++;
+            return lane;
+        }
+
+        // Remove a lane. Items already queued on the lane may still be handled.
+        void RemoveLane(const std::shared_ptr<Lane>& lane)
+        {
+            std::lock_guard<std::mutex> lock(lanes_mutex_);
+            lanes_.erase(std::remove(lanes_.begin(), lanes_.end(), lane), lanes_.end());
+            lanes_version_++;
+        }
+
+        // Queue an item on the lane. Returns false and drops the item if the lane is full.
+        bool Dispatch(Lane& lane, T&& item)
+        {
+            if (!lane.TryPush(std::move(item)))
+            {
+                dropped_count_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Pairs with the fence in Run so either the executor sees the item or we see that it is sleeping
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping_.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                wake_cv_.notify_one();
+            }
+            return true;
+        }
+
+        // Total number of items waiting to be handled across all lanes
+        size_t GetQueueDepth()
+        {
+            size_t depth = 0;
+            std::lock_guard<std::mutex> lock(lanes_mutex_);
+            for (auto& lane : lanes_)
+            {
+                depth += lane->Size();
+            }
+            return depth;
+        }
+
+        // Total number of items dropped because their lane was full
+        uint64_t GetDroppedCount() const
+        {
+            return dropped_count_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // Maximum number of items handled from one lane before moving to the next, so one busy device cannot starve others
+        static constexpr size_t max_items_per_lane_pass = 64;
+
+        // Wake up periodically even without a notification as a safety net
+        static constexpr std::chrono::milliseconds idle_wait_timeout{ 100 };
+
+        void Run()
+        {
+            std::vector<std::shared_ptr<Lane>> lanes;
+            uint64_t lanes_version = 0;
+            T item{};
+
+            while (true)
+            {
+                // Refresh the local lane snapshot if lanes were added or removed
+                {
+                    std::lock_guard<std::mutex> lock(lanes_mutex_);
+                    if (lanes_version != lanes_version_ || lanes.size() != lanes_.size())
+                    {
+                        lanes = lanes_;
+                        lanes_version = lanes_version_;
+                    }
+                }
+
+                bool handled = false;
+                for (auto& lane : lanes)
+                {
+                    for (size_t i = 0; i < max_items_per_lane_pass && lane->TryPop(item); i++)
+                    {
+                        handler_(item);
+                        handled = true;
+                    }
+                }
+
+                if (handled)
+                {
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                if (stop_)
+                {
+                    return;
+                }
+
+                sleeping_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bool pending = std::any_of(lanes.begin(), lanes.end(), [](const std::shared_ptr<Lane>& lane) { return !lane->Empty(); });
+                if (!pending)
+                {
+                    wake_cv_.wait_for(lock, idle_wait_timeout);
+                }
+                sleeping_.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        std::function<void(T&)> handler_;
+        const size_t lane_capacity_;
+
+        std::mutex lanes_mutex_;
+        std::vector<std::shared_ptr<Lane>> lanes_;
+        uint64_t lanes_version_ = 0;
+
+        std::atomic<uint64_t> dropped_count_{ 0 };
+
+        std::mutex wake_mutex_;
+        std::condition_variable wake_cv_;
+        std::atomic<bool> sleeping_{ false };
+        bool stop_ = false;
+
+        std::thread executor_thread_;
+    };
+}  // namespace ommo
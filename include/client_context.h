@@ -40,6 +40,15 @@ namespace ommo::api
          */
         explicit ClientContext(const char* server_address = nullptr);
 
+        /*
+         * Creates a ClientContext object that processes incoming data on <completion_queue_count> threads.
+         *
+         * Each data stream is pinned to one thread by device, so data for a single device is always delivered
+         * in order. Data for different devices may be delivered concurrently, so registered data callbacks must be
+         * thread safe when more than one thread is used. Values less than 1 are treated as 1.
+         */
+        ClientContext(const char* server_address, uint32_t completion_queue_count);
+
         /*
          * The copying of ClientContext is disabled to prevent issues related to memory management and ABI compatibility.
          */
@@ -107,6 +116,34 @@ namespace ommo::api
          */
         void ResetChannelStateCallback();
 
+        /*
+         * Set how long device events are collected before DataFrame request streams are updated for them.
+         * When many devices connect or disconnect together, each DataFrame request reopens its stream once for the
+         * whole batch instead of once per device. DeviceData requests and the device event callback are not delayed.
+         * A window of 0 updates the streams for every event. Defaults to 50ms.
+         */
+        void SetDeviceEventBatchWindow(uint32_t milliseconds);
+
+        /*
+         * Decode the data of DeviceData and DataFrame requests straight from the received bytes into the data storage
+         * instead of parsing protobuf messages first. Applies to requests made afterwards. Requests with a registered
+         * callback still parse each packet for the callback. Disabled by default.
+         */
+        void SetWireDecoding(bool enabled);
+
+        /*
+         * Also store the received data of every device as columns, see GetHistoryView. Applies to requests made
+         * afterwards. Disabled by default.
+         */
+        void SetColumnarHistory(bool enabled);
+
+        /*
+         * Keep packets received with wire decoding encoded and only convert the packets that are read. Applies to
+         * requests made afterwards. Data views are not available for these requests, and the option is ignored
+         * together with SetColumnarHistory. Disabled by default.
+         */
+        void SetConvertOnRead(bool enabled);
+
         /*
          * Request real-time data from one or more devices. Data is returned individually for each device as
          * soon as it is ready. This request is suitable for scenarios where having the most recent data
@@ -152,6 +189,14 @@ namespace ommo::api
          */
         api::DeviceIDList* GetAvailableDeviceList(uint32_t request_tag);
 
+        /*
+         * Copy the list of devices associated with the request into a caller owned buffer without allocating.
+         *
+         * Returns the number of available devices. If it is larger than the buffer capacity, only the first
+         * <device_capacity> devices are copied.
+         */
+        uint32_t GetAvailableDeviceList(uint32_t request_tag, api::DeviceIDBuffer& buffer);
+
         /*
          * Request the most recent data received for the specified request and device.
          * 
@@ -173,6 +218,77 @@ namespace ommo::api
          */
         api::DataResponse* GetDataSinceIndex(uint32_t request_tag, const api::DeviceID& device_id, int32_t start_index);
 
+        /*
+         * Borrow the most recent <num_packets> data received for the specified request and device without copying it.
+         *
+         * The DataView state should be checked to ensure that data is available. Data keeps being received while the
+         * view exists, so check IsDataViewValid after reading from the view. Destroy the view with DestroyDataView.
+         * At most one packet less than the storage buffer size can be viewed. Requests made with SetConvertOnRead
+         * enabled return kNoData, their packets are only converted when copied.
+         */
+        api::DataView* GetLatestDataView(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets);
+
+        /*
+         * Request all data received for the specified request and device with a time within [start_time, end_time].
+         *
+         * <time_base> selects which time of the packets is compared. The packets are found by binary search over a time index.
+         * The DataResponse state should be checked to ensure that data is available.
+         */
+        api::DataResponse* GetDataInTimeRange(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t start_time, uint64_t end_time);
+
+        /*
+         * Request the sample received for the specified request and device with the time closest to <time>.
+         *
+         * The DataResponse state should be checked to ensure that data is available.
+         */
+        api::DataResponse* GetNearestSample(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t time);
+
+        /*
+         * Borrow the columnar history of the most recent <num_packets> data received for one sensor unit of the specified request and device.
+         *
+         * Each value is exposed as a contiguous column so it can be processed with vectorized math. The request must have been made
+         * with SetColumnarHistory enabled, otherwise kNoData is returned. Check IsHistoryViewValid after reading from the view and
+         * destroy it with DestroyHistoryView.
+         */
+        api::HistoryView* GetHistoryView(uint32_t request_tag, const api::DeviceID& device_id, uint32_t sensor_unit_index, int32_t num_packets);
+
+        /*
+         * Create a cursor for ReadNewData that starts at the next packet received for the specified request and device.
+         */
+        api::DataCursor GetDataCursor(uint32_t request_tag, const api::DeviceID& device_id);
+
+        /*
+         * Request the data received for the specified request and device since the last read with <cursor>, and advance the cursor.
+         *
+         * The cursor reports how many packets were overwritten before they could be read. Each consumer should use its own cursor.
+         * The DataResponse state should be checked to ensure that data is available.
+         */
+        api::DataResponse* ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor);
+
+        /*
+         * Copy the data received for the specified request and device since the last read with <cursor> into a caller owned buffer.
+         *
+         * If the buffer is too small, the cursor stops after the last copied packet and kPartialData is returned.
+         */
+        api::DataResponseState ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor, api::DevicePacketBuffer& buffer);
+
+        /*
+         * Copy the most recent <num_packets> data received for the specified request and device into a caller owned buffer.
+         *
+         * Nothing is allocated, so a buffer can be reused for every call. If the buffer is too small, the newest packets
+         * that fit are copied and kPartialData is returned. The returned state should be checked to ensure that data is available.
+         */
+        api::DataResponseState GetLatestData(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets, api::DevicePacketBuffer& buffer);
+
+        /*
+         * Copy all data received since <start_index> for the specified request and device into a caller owned buffer.
+         *
+         * Nothing is allocated, so a buffer can be reused for every call. If the buffer is too small, the oldest packets
+         * that fit are copied and kPartialData is returned, continue from the index after the last copied packet.
+         * The returned state should be checked to ensure that data is available.
+         */
+        api::DataResponseState GetDataSinceIndex(uint32_t request_tag, const api::DeviceID& device_id, int32_t start_index, api::DevicePacketBuffer& buffer);
+
         /*
          * Request the most recent data received for the base station.
          * 
@@ -194,6 +310,20 @@ namespace ommo::api
          */
         api::BaseStationDataResponse* GetBaseStationDataSinceIndex(uint32_t request_tag, int32_t start_index);
 
+        /*
+         * Copy the most recent <num_packets> data received for the base station into a caller owned buffer.
+         *
+         * Nothing is allocated. If the buffer is too small, the newest packets that fit are copied and kPartialData is returned.
+         */
+        api::DataResponseState GetLatestBaseStationData(uint32_t request_tag, int32_t num_packets, api::BaseStationPacketBuffer& buffer);
+
+        /*
+         * Copy all data received since <start_index> for the base station into a caller owned buffer.
+         *
+         * Nothing is allocated. If the buffer is too small, the oldest packets that fit are copied and kPartialData is returned.
+         */
+        api::DataResponseState GetBaseStationDataSinceIndex(uint32_t request_tag, int32_t start_index, api::BaseStationPacketBuffer& buffer);
+
         /* 
          * Register a call back to be called whenever a TrackingDeviceData is received for the Request identified by request_tag
          * 
@@ -226,6 +356,30 @@ namespace ommo::api
          */
         void ResetDataFrameCallback(uint32_t request_tag);
 
+        /*
+         * Select where the data callbacks for the Request identified by request_tag are run.
+         *
+         * By default callbacks are run on the thread receiving the data, so a slow callback delays data for every Request.
+         * When enabled, received data is queued and the callbacks are run on a dedicated thread for this Request instead.
+         * Each device (or the DataFrame stream) has its own queue holding up to queue_capacity packets. New packets are
+         * dropped while a queue is full, see GetCallbackQueueDepth and GetDroppedCallbackCount.
+         *
+         * Changing the mode discards any queued packets. Must not be called from within a data callback.
+         */
+        void SetCallbackDispatchMode(uint32_t request_tag, bool enabled, uint32_t queue_capacity = 1024);
+
+        /*
+         * Return the number of packets waiting for the callback of the Request identified by request_tag.
+         *
+         * Always 0 unless callback dispatch is enabled for the Request.
+         */
+        size_t GetCallbackQueueDepth(uint32_t request_tag);
+
+        /*
+         * Return the number of packets dropped because the callback queue of the Request identified by request_tag was full.
+         */
+        uint64_t GetDroppedCallbackCount(uint32_t request_tag);
+
         /*
          * Create a WirelessManager that can be used to manage wireless devices via the ommo service.
          * @return pointer of the created WirelessManager.
@@ -261,6 +415,29 @@ namespace ommo::api
          */
         bool SelectReferenceDevice(bool enabled, uint32_t siu_uuid, uint32_t port_num);
 
+        /*
+         * The following are asynchronous variants of GetTrackingDevices, GetHardwareStates, SetBaseStationMotorRunning,
+         * EnableDataLogging, DisableDataLogging and SelectReferenceDevice.
+         *
+         * They return immediately and the callback is called from an internal thread once the call completes, fails or
+         * exceeds timeout_ms (0 means no deadline). The callback must not block for long. Many calls can be in flight at once.
+         * On failure the callback receives the same value the synchronous function returns on failure.
+         * The callback takes ownership of returned pointers in the same way the caller of the synchronous function does.
+         * The ClientContext must be started before calling these functions. Shutdown cancels the calls in flight, and calls
+         * made after Shutdown fail right away. Either way the callback still runs with the failure value.
+         */
+        void GetTrackingDevicesAsync(std::function<void(api::TrackingDevices*)> callback, uint32_t timeout_ms = 5000);
+
+        void GetHardwareStatesAsync(std::function<void(api::HardwareStates*)> callback, uint32_t timeout_ms = 5000);
+
+        void SetBaseStationMotorRunningAsync(bool active, std::function<void(bool)> callback, uint32_t timeout_ms = 5000);
+
+        void EnableDataLoggingAsync(const char* directory, const char* file_name, bool overwrite, std::function<void(api::DataLogState)> callback, uint32_t timeout_ms = 5000);
+
+        void DisableDataLoggingAsync(std::function<void(api::DataLogState)> callback, uint32_t timeout_ms = 5000);
+
+        void SelectReferenceDeviceAsync(bool enabled, uint32_t siu_uuid, uint32_t port_num, std::function<void(bool)> callback, uint32_t timeout_ms = 5000);
+
     private:
         class impl;
         ClientContext::impl* const p_impl_;
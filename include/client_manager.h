@@ -13,12 +13,18 @@
 #include <thread>
 #include <atomic>
 #include <iomanip>
+#include <unordered_set>
+#include <vector>
 
 #include "basestation_data_storage.h"
 #include "data_manager.h"
+#include "grpcpp/alarm.h"
+#include "grpcpp/generic/generic_stub.h"
 #include "grpcpp/grpcpp.h"
 #include "ommo_service_api.grpc.pb.h"
 #include "rpcClientCallData.h"
+#include "shared_device_data_stream.h"
+#include "unary_call_registry.h"
 
 class RpcWirelessManagementStreamClientCallData;
 
@@ -43,7 +49,14 @@ namespace ommo
     class ClientManager
     {
     public:
-        explicit ClientManager(std::string server_address);
+        /*
+         * Create a ClientManager for the service at server_address.
+         *
+         * completion_queue_count sets how many gRPC completion queues (each drained by its own thread) are used to
+         * process stream events. Each stream is pinned to one queue by device, so data for a single device is always
+         * delivered in order while different devices can be processed in parallel. Values less than 1 are treated as 1.
+         */
+        explicit ClientManager(std::string server_address, uint32_t completion_queue_count = 1);
         ~ClientManager();
 
         /*
@@ -97,6 +110,32 @@ namespace ommo
          */
         void ResetChannelStateCallback();
 
+        /*
+         * Set how long device events are collected before DataFrame streams are reopened for them.
+         * Devices connecting or disconnecting together (e.g. at startup or when an SIU is plugged in) then cause a
+         * single stream reopen per DataFrame request instead of one per device. Device data streams and the device
+         * event callback are not delayed. A window of 0 reopens the stream for every event. Defaults to 50ms.
+         */
+        void SetDeviceEventBatchWindow(uint32_t milliseconds);
+
+        /*
+         * Decode device data and data frame streams straight from the received bytes into the device data storage
+         * instead of parsing protobuf messages first. Applies to streams opened afterwards. Requests with a
+         * registered callback still parse a message for the callback. Disabled by default.
+         */
+        void SetWireDecoding(bool enabled);
+
+        /*
+         * Also store the received data of every device as columns for history views. Applies to requests made
+         * afterwards. Disabled by default.
+         */
+        void SetColumnarHistory(bool enabled);
+
+        /*
+         * Keep packets received with wire decoding encoded in the device data storage and only convert the packets
+         * that are read. Applies to requests made afterwards. Ignored together with columnar history. Disabled by default.
+         */
+        void SetConvertOnRead(bool enabled);
 
         /*
          * Request real-time data from one or more devices. Data is returned individually for each device as
@@ -173,6 +212,25 @@ namespace ommo
          */
         bool SelectReferenceDevice(bool enabled, uint32_t siu_uuid, uint32_t port_num);
 
+        /*
+         * The following are asynchronous variants of the control functions above. They return immediately and call
+         * the callback from a completion queue thread once the RPC completes, fails, or exceeds timeout_ms.
+         * A timeout_ms of 0 means no deadline. Any number of calls can be in flight at the same time.
+         * On failure the callbacks receive the same values the synchronous functions return on failure.
+         * Shutdown cancels the calls in flight. Calls made after Shutdown are not started and fail right away.
+         */
+        void GetTrackingDevicesAsync(std::function<void(api::TrackingDevicesUPtr)> callback, uint32_t timeout_ms);
+
+        void GetHardwareStatesAsync(std::function<void(api::HardwareStatesUPtr)> callback, uint32_t timeout_ms);
+
+        void SetBaseStationMotorRunningAsync(bool active, std::function<void(bool)> callback, uint32_t timeout_ms);
+
+        void EnableDataLoggingAsync(std::string directory, std::string file_name, bool overwrite, std::function<void(api::DataLogState)> callback, uint32_t timeout_ms);
+
+        void DisableDataLoggingAsync(std::function<void(api::DataLogState)> callback, uint32_t timeout_ms);
+
+        void SelectReferenceDeviceAsync(bool enabled, uint32_t siu_uuid, uint32_t port_num, std::function<void(bool)> callback, uint32_t timeout_ms);
+
         /*
          * The following are low level access functions for more advance gRPC API usage. They are direct replacements for
          * legacy rpcOmmoClientManager functions.
@@ -184,6 +242,12 @@ namespace ommo
          */
         rpcClientCallData* OpenTrackingDeviceDataStream(const ommo::TrackingDeviceDataStreamRequest& request, const std::function<void(const ommo::TrackingDeviceData&)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{});
 
+        /*
+         * Same as OpenTrackingDeviceDataStream, but the listener function receives the encoded ommo::TrackingDeviceData
+         * bytes of each packet. The bytes are only valid during the call.
+         */
+        rpcClientCallData* OpenEncodedTrackingDeviceDataStream(const ommo::TrackingDeviceDataStreamRequest& request, const std::function<void(const uint8_t*, size_t)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{});
+
         /*
          * Manually open a tracking device event stream. Tracking device events are returned to the listener function when received from ommo service
          */
@@ -196,6 +260,12 @@ namespace ommo
          */
         rpcClientCallData* OpenDataFrameStream(const ommo::DataFrameStreamRequest& request, const std::function<void(const ommo::DataFrame&)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{});
 
+        /*
+         * Same as OpenDataFrameStream, but the listener function receives the encoded ommo::DataFrame bytes of each
+         * frame. The bytes are only valid during the call.
+         */
+        rpcClientCallData* OpenEncodedDataFrameStream(const ommo::DataFrameStreamRequest& request, const std::function<void(const uint8_t*, size_t)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{});
+
         /*
          * Manually open a base station data stream. Base station data packets are returned to the provided listener function when received from ommo service.
          */
@@ -225,10 +295,32 @@ namespace ommo
         void DeviceEventProcessor(const ommo::TrackingDeviceEvent& device_event);
 
         // Monitor the gRPC channel status. Opens a DeviceEventStream when the channel is able to be used.
+        // The monitor waits for channel state changes on its own completion queue instead of polling.
         void ChannelMonitor();
 
-        // Handle the events put onto the gRPC completion queue
-        void CompletionQueueProcessor();
+        // Add a DataManager to the data manager list and the device routing index. Requires data_manager_list_mutex_.
+        void AddDataManager(const std::shared_ptr<DataManager>& data_manager_ptr);
+
+        // Remove a DataManager from the data manager list and the device routing index. Requires data_manager_list_mutex_.
+        void RemoveDataManager(const std::shared_ptr<DataManager>& data_manager_ptr);
+
+        // Update a DataManager's stream according to a device event
+        void RouteDeviceEvent(const std::shared_ptr<DataManager>& data_manager_ptr, api::DeviceDescriptor& device, bool device_connected);
+
+        // Handle the events put onto the provided gRPC completion queue
+        void CompletionQueueProcessor(CompletionQueue* completion_queue);
+
+        // Get the completion queue a stream with the given affinity key is pinned to
+        CompletionQueue* GetCompletionQueue(uint64_t affinity_key);
+
+        // Start an asynchronous unary call tracked by unary_calls_. Once the client is shut down the call is not
+        // started and the handler is called right away with an UNAVAILABLE status.
+        template <typename Request, typename Response>
+        void StartUnaryCall(
+            std::unique_ptr<ClientAsyncResponseReader<Response>> (ommo::CoreService::Stub::*prepare_function)(ClientContext*, const Request&, CompletionQueue*),
+            const Request& request,
+            uint32_t timeout_ms,
+            const std::function<void(const Status&, Response&)>& handler);
 
         // Open a device data stream for a DataManager
         void OpenDeviceDataStream(std::shared_ptr<DataManager> data_manager_ptr);
@@ -236,14 +328,30 @@ namespace ommo
         // Update the DataManager's device data stream based on the specified device's state
         void UpdateDeviceDataStream(std::shared_ptr<DataManager> data_manager_ptr, api::DeviceDescriptor& device, bool device_connected);
 
-        // Open a data frame stream for a DataManager
-        void OpenDataFrame(std::shared_ptr<DataManager> data_manager_ptr);
+        // Subscribe the DataManager to the upstream stream of the device, opening the stream if no other DataManager
+        // requested the device with the same stream parameters
+        std::shared_ptr<SharedDeviceDataStream> AcquireDeviceDataStream(const std::shared_ptr<DataManager>& data_manager_ptr, const api::DeviceDescriptor& device);
+
+        // Open a data frame stream for a DataManager. With make_before_break set, an open stream is kept until the new
+        // stream delivers its first frame.
+        void OpenDataFrame(std::shared_ptr<DataManager> data_manager_ptr, bool make_before_break = false);
 
         // Update the DataManager's data frame stream based on the specified device's state
         void UpdateDataFrameStream(std::shared_ptr<DataManager> data_manager_ptr, api::DeviceDescriptor& device, bool device_connected);
 
-        // gRPC completion queue
-        CompletionQueue completion_queue_;
+        // Queue a data frame stream reopen for the DataManager. The reopen is applied by the channel monitor once the
+        // device event batch window expires.
+        void ScheduleDataFrameReopen(std::shared_ptr<DataManager> data_manager_ptr);
+
+        // Reopen the data frame streams of all DataManagers queued during the device event batch window
+        void ApplyDeviceEventBatch();
+
+        // gRPC completion queues. Streams are distributed across the queues by affinity key.
+        std::vector<std::unique_ptr<CompletionQueue>> completion_queues_;
+
+        // Asynchronous unary calls in flight, cancelled on Shutdown. Stopped for good, since the completion queues
+        // are not restarted.
+        std::shared_ptr<UnaryCallRegistry> unary_calls_ = std::make_shared<UnaryCallRegistry>();
 
         // gRPC server location. Defaults to localhost:50051
         std::string server_address_;
@@ -251,23 +359,61 @@ namespace ommo
         // gRPC channel
         std::shared_ptr<Channel> channel_;
 
+        // gRPC stub for channel_, shared by all RPCs and call data
+        std::shared_ptr<ommo::CoreService::Stub> stub_;
+
+        // Generic stub for channel_, used by the streams that hand out encoded messages
+        std::shared_ptr<grpc::GenericStub> generic_stub_;
+
+        // Open device data and data frame streams with wire decoding
+        std::atomic<bool> wire_decoding_{ false };
+
+        // Storage options of the data managers of new requests
+        std::atomic<bool> columnar_history_{ false };
+        std::atomic<bool> convert_on_read_{ false };
+
         // Lockable object to protect the connected devices map
         std::mutex connected_devices_mtx_;
 
         // Store the connected devices by device hash
         std::unordered_map<uint64_t, api::DeviceDescriptorUPtr> connected_devices_;
 
-        // Flag to signal channel monitor to stop
-        std::atomic<bool> stop_channel_monitor_{ false };
-
         // Thread to monitor gRPC channel state
         std::unique_ptr<std::thread> channel_monitor_thread_;
 
+        // Completion queue receiving the channel state change notifications for the channel monitor.
+        // Shut down only when the ClientManager is destroyed.
+        std::unique_ptr<CompletionQueue> monitor_cq_;
+
+        // Whether a channel state watch is outstanding on monitor_cq_. Only used by the channel monitor thread.
+        bool channel_watch_pending_ = false;
+
+        // Alarm used to wake the channel monitor immediately on shutdown
+        std::unique_ptr<grpc::Alarm> channel_monitor_wake_alarm_;
+
+        // Lockable object to protect the device event batch state
+        std::mutex device_event_batch_mutex_;
+
+        // Alarm firing on the monitor completion queue when the device event batch window expires
+        std::unique_ptr<grpc::Alarm> device_event_batch_alarm_;
+
+        // Whether device_event_batch_alarm_ is currently set
+        bool device_event_batch_pending_ = false;
+
+        // Set by Shutdown before the channel monitor stops. Device events no longer schedule data frame reopens.
+        bool device_event_batching_stopped_ = false;
+
+        // DataManagers whose data frame stream is reopened when the batch window expires
+        std::unordered_set<std::shared_ptr<DataManager>> pending_dataframe_reopens_;
+
+        // Time to collect device events before reopening data frame streams, in milliseconds
+        std::atomic<uint32_t> device_event_batch_window_ms_{ 50 };
+
         // Flag to signal completion queue handling to stop
         std::atomic<bool> stop_handling_cq_{ false };
 
-        // Thread to handle completion queue
-        std::unique_ptr<std::thread> handle_cq_thread_;
+        // Threads to handle completion queues. There is one thread per completion queue.
+        std::vector<std::unique_ptr<std::thread>> handle_cq_threads_;
 
         /*
          * Store the most recent gRPC channel state.
@@ -290,6 +436,18 @@ namespace ommo
         // Store the DataManagers created when requests are opened
         std::vector<std::shared_ptr<DataManager>> data_manager_list_;
 
+        // DataManagers that requested specific devices, by device hash. Protected by data_manager_list_mutex_.
+        std::unordered_map<uint64_t, std::vector<std::shared_ptr<DataManager>>> device_routing_index_;
+
+        // DataManagers with an empty request list, interested in every device. Protected by data_manager_list_mutex_.
+        std::vector<std::shared_ptr<DataManager>> all_devices_data_managers_;
+
+        // Lockable object to protect the shared device data stream map
+        std::mutex shared_device_streams_mutex_;
+
+        // Upstream device data streams by stream parameters. The subscribed DataManagers own the streams.
+        std::unordered_map<DeviceDataStreamKey, std::weak_ptr<SharedDeviceDataStream>, DeviceDataStreamKeyHash> shared_device_streams_;
+
         // Mutex variable to protect the base station storage list.
         std::mutex base_station_data_storage_list_mutex_;
     
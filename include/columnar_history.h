@@ -0,0 +1,79 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "sdk_types.h"
+
+namespace ommo
+{
+    /*
+     * Structure-of-arrays copy of the packets stored for a device.
+     *
+     * Every value of a packet is stored in its own contiguous column, one column per value and sensor unit, so
+     * history can be processed with vectorized math without chasing the member pointers of each packet.
+     * Rows are indexed like the slots of the owning DeviceDataStorage and are protected by the same slot sequences.
+     */
+    class ColumnarHistory
+    {
+    public:
+        enum class FloatColumn : uint32_t
+        {
+            kPositionX,
+            kPositionY,
+            kPositionZ,
+            kQuaternionW,
+            kQuaternionX,
+            kQuaternionY,
+            kQuaternionZ,
+            kIndicatorValue,
+            kMotionIndicator,
+            kBadDataIndicator,
+            kCount
+        };
+
+        enum class IntColumn : uint32_t
+        {
+            kAccelX,
+            kAccelY,
+            kAccelZ,
+            kGyroX,
+            kGyroY,
+            kGyroZ,
+            kMagX,
+            kMagY,
+            kMagZ,
+            kCount
+        };
+
+        ColumnarHistory(uint32_t row_count, uint32_t sensor_unit_count);
+
+        // Fill <row> from the packet. Sensor units missing from the packet are stored as zero.
+        void WriteRow(uint32_t row, const api::TrackingDeviceData& data);
+
+        uint32_t GetSensorUnitCount() const;
+
+        const uint32_t* GetTimestamps() const;
+        const float* GetColumn(FloatColumn column, uint32_t sensor_unit) const;
+        const int32_t* GetColumn(IntColumn column, uint32_t sensor_unit) const;
+
+    private:
+        float& FloatValue(FloatColumn column, uint32_t sensor_unit, uint32_t row);
+        int32_t& IntValue(IntColumn column, uint32_t sensor_unit, uint32_t row);
+
+        const uint32_t row_count_;
+        const uint32_t sensor_unit_count_;
+
+        std::unique_ptr<uint32_t[]> timestamps_;
+        // Columns are laid out as [column][sensor unit][row]
+        std::unique_ptr<float[]> float_columns_;
+        std::unique_ptr<int32_t[]> int_columns_;
+    };
+}  // namespace ommo
@@ -10,12 +10,16 @@
 
 #include <map>
 #include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "callback_dispatcher.h"
 #include "device_data_storage.h"
 #include "ommo_service_api.pb.h"
 #include "rpcClientCallData.h"
 #include "sdk_types.h"
+#include "shared_device_data_stream.h"
 
 
 namespace ommo
@@ -23,7 +27,8 @@ namespace ommo
     class DataManager : public CallDataAssociation
     {
     public:
-        DataManager(const api::DataRequest& request, api::DataStreamType stream_type);
+        // <store_columnar_history> and <convert_on_read> are passed to the storage of every device, see DeviceDataStorage
+        DataManager(const api::DataRequest& request, api::DataStreamType stream_type, bool store_columnar_history = false, bool convert_on_read = false);
         ~DataManager() = default;
 
         // Get the DataRequest assigned to this DataManager
@@ -32,8 +37,17 @@ namespace ommo
 
         bool IsDeviceDataRequested(const api::DeviceID& device_id);
 
+        // Whether the request has no device list and therefore covers all devices
+        bool IsAllDevicesRequested() const;
+
+        // Hashes of the devices in the request list. Empty if all devices are requested.
+        const std::unordered_set<uint64_t>& GetRequestedDeviceHashes() const;
+
         // Return the list of devices with created storage
         api::DeviceIDListUPtr GetDeviceStorageList();
+        // Copy the list of devices with created storage into the caller owned buffer.
+        // Returns the number of devices, which can be more than the buffer holds.
+        uint32_t GetDeviceStorageList(api::DeviceIDBuffer& buffer);
 
         // Storage related functions
         void AddDeviceStorage(const api::DeviceDescriptor& device, int32_t buffer_size = 500);
@@ -45,8 +59,22 @@ namespace ommo
         bool IsStorageAvailable(const api::DeviceDescriptor& device);
         bool IsStorageAvailable(const api::DeviceID& device_id);
 
-        void UpdateDeviceData(const ommo::TrackingDeviceData& packet);
-        void UpdateDataFrame(const ommo::DataFrame& packet);
+        // Get the storage slot of a device, creating an empty slot if the device has none yet
+        std::shared_ptr<DeviceStorageSlot> GetStorageSlot(uint64_t hash);
+
+        // Handle a packet received for the device of <slot>
+        void UpdateDeviceData(const ommo::TrackingDeviceData& packet, DeviceStorageSlot& slot);
+        // Handle a packet that was already converted, sharing it with the callback instead of converting it again
+        void UpdateDeviceData(const api::TrackingDeviceDataSPtr& packet, DeviceStorageSlot& slot);
+        // Handle a DataFrame received from the data frame stream of <stream_generation>, storing the device data in
+        // the slots resolved for that stream. The first frame of a replacement stream switches over to it, frames of
+        // replaced streams are dropped.
+        void UpdateDataFrame(const ommo::DataFrame& packet, uint64_t stream_generation, const DeviceStorageSlotTable& slots);
+        // Same as above for packets received as encoded protobuf bytes. The device data is decoded straight into the
+        // storage, or decoded once and shared with the callback when one is registered. A data frame message is only
+        // parsed when a callback is registered.
+        void UpdateDeviceData(const uint8_t* data, size_t size, DeviceStorageSlot& slot);
+        void UpdateDataFrame(const uint8_t* data, size_t size, uint64_t stream_generation, const DeviceStorageSlotTable& slots);
 
         // Register a call back to be called whenever a TrackingDeviceData is received via UpdateDeviceData
         // Register function will do nothing unless stream_type of the DataManager is kDeviceData
@@ -62,52 +90,112 @@ namespace ommo
         // Reset the currently registered callback for DataFrame so it'll no longer be called
         void ResetDataFrameCallback();
 
+        // Run the registered callbacks on a dedicated executor thread instead of the gRPC completion queue thread.
+        // Received data is queued on a bounded queue per device (one queue for DataFrame streams) holding up to
+        // <queue_capacity> packets. Packets are dropped when a queue is full so a slow callback cannot stall data ingest.
+        // Calling this while dispatch is already enabled restarts the dispatch and discards queued packets.
+        void EnableCallbackDispatch(uint32_t queue_capacity);
+        // Go back to running the callbacks on the completion queue thread. Queued packets are discarded.
+        // Must not be called from within a callback.
+        void DisableCallbackDispatch();
+        bool IsCallbackDispatchEnabled();
+        // Number of packets waiting for the callback. Always 0 when dispatch is disabled.
+        size_t GetCallbackQueueDepth();
+        // Number of packets dropped because the callback queue was full since dispatch was enabled.
+        uint64_t GetDroppedCallbackCount();
+
         // Get the latest data for the requested device
         api::DataResponseUPtr GetLatestData(const api::DeviceID& device_id);
         // Get the latest <num_packets> of data for the requested device
         api::DataResponseUPtr GetLatestData(const api::DeviceID& device_id, int32_t num_packets);
         // Get all data since <start_idx> for the requested device
         api::DataResponseUPtr GetDataSinceIndex(const api::DeviceID& device_id, int32_t start_idx);
-
-        // Store the data stream pointer of a tracking device to this DataManager.
-        bool AddDataStream(const api::DeviceID& device_id, rpcClientCallData* call_data);
+        // Borrow the latest <num_packets> of data for the requested device without copying
+        api::DataViewUPtr GetLatestDataView(const api::DeviceID& device_id, int32_t num_packets);
+        // Get the data of the requested device with a time within [start_time, end_time]
+        api::DataResponseUPtr GetDataInTimeRange(const api::DeviceID& device_id, api::TimeBase time_base, uint64_t start_time, uint64_t end_time);
+        // Get the sample of the requested device closest to <time>
+        api::DataResponseUPtr GetNearestSample(const api::DeviceID& device_id, api::TimeBase time_base, uint64_t time);
+        // Borrow the columnar history of the latest <num_packets> of a sensor unit of the requested device.
+        // Requires the DataManager to be created with store_columnar_history.
+        api::HistoryViewUPtr GetHistoryView(const api::DeviceID& device_id, uint32_t sensor_unit_index, int32_t num_packets);
+        // Cursor position at the next packet received for the requested device
+        api::DataCursor GetDataCursor(const api::DeviceID& device_id);
+        // Get the data received for the requested device since the last read with <cursor>
+        api::DataResponseUPtr ReadNewData(const api::DeviceID& device_id, api::DataCursor& cursor);
+        api::DataResponseState ReadNewData(const api::DeviceID& device_id, api::DataCursor& cursor, api::DevicePacketBuffer& buffer);
+        // Buffer variants of the get data functions above, they copy into the caller owned buffer without allocating
+        api::DataResponseState GetLatestData(const api::DeviceID& device_id, int32_t count, api::DevicePacketBuffer& buffer);
+        api::DataResponseState GetDataSinceIndex(const api::DeviceID& device_id, int32_t start_idx, api::DevicePacketBuffer& buffer);
+
+        // Store the shared data stream of a tracking device this DataManager is subscribed to.
+        bool AddDataStream(const api::DeviceID& device_id, std::shared_ptr<SharedDeviceDataStream> stream);
         // Remove the data stream of the given tracking device from this DataManager.
         bool RemoveDataStream(const api::DeviceID& device_id);
         // Check if the data stream pointer of the given devices exists.
         bool DataStreamExists(const api::DeviceID& device_id);
-        // Cancel the data stream associated with the given tracking device. The call data will be deleted by completion queue.
+        // Unsubscribe from the data stream of the given tracking device. The stream is cancelled once no DataManager uses it.
         bool CancelDataStream(const api::DeviceID& device_id); 
 
-        // Cancel all data streams associated with this DataManager.
+        // Unsubscribe from all data streams associated with this DataManager.
         void CancelAllDataStreams();
         // Remove all data stream pointer saved in this DataManager.
         void ClearDataStreams();
-        // Store the DataFrame stream pointer in this DataManager.
-        void SetDataFrameStream(rpcClientCallData* call_data);
-        // Remove the DataFrame stream pointer from this DataManager.
+        // Start a new DataFrame stream and return its generation, which must be passed with its frames.
+        // With make_before_break set and a stream already open, the new stream replaces the current one once it
+        // delivers its first frame. Otherwise the current stream is cancelled right away.
+        uint64_t BeginDataFrameStream(bool make_before_break);
+        // Store the DataFrame stream pointer of <generation> in this DataManager.
+        void SetDataFrameStream(rpcClientCallData* call_data, uint64_t generation);
+        // Remove the DataFrame stream pointers from this DataManager.
         void RemoveDataFrameStream();
-        // Cancel the DataFrame stream associated with this DataManager. The call data will be deleted by completion queue.
+        // Cancel the DataFrame streams associated with this DataManager. The call data will be deleted by completion queue.
         bool CancelDataFrameStream();
 
         // Remove the stream pointer from this DataManager if it is stored.
         bool RemoveStream(rpcClientCallData* call_data);
+        bool RemoveStream(const SharedDeviceDataStream* stream);
 
         virtual bool ClearAssociation(void* call_data_ptr) override;
 
     private:
+        using DeviceDataDispatcher = CallbackDispatcher<api::TrackingDeviceDataSPtr>;
+        using DataFrameDispatcher = CallbackDispatcher<api::DataFrameSPtr>;
+
+        // Queue the packet for the callback executor. Returns false if dispatch is disabled.
+        bool DispatchDeviceData(const api::TrackingDeviceDataSPtr& packet);
+        bool DispatchDataFrame(const api::DataFrameSPtr& packet);
+
+        // Check the generation of a received DataFrame, switching over to a pending replacement stream on its first frame.
+        // Returns false if the frame comes from a replaced stream and must be dropped.
+        bool AcceptDataFrame(uint64_t stream_generation);
+        // Find the slot of the <position>-th device of a DataFrame in the slot table of its stream
+        static const DeviceStorageSlot* FindStorageSlot(const DeviceStorageSlotTable& slots, size_t position, uint64_t device_hash);
+
         // Lock to protect access to the device data map
         std::shared_mutex device_data_map_mtx_;
         // Storage for device data storage
-        std::map<uint64_t, std::unique_ptr<DeviceDataStorage>> device_data_map_;
+        // Shared so borrowed data views can keep a storage alive after it is removed
+        std::map<uint64_t, std::shared_ptr<DeviceDataStorage>> device_data_map_;
+        // Storage slots handed out to streams by device key. Protected by device_data_map_mtx_. Slots are never
+        // removed, AddDeviceStorage and RemoveDeviceStorage fill and empty them.
+        std::unordered_map<uint64_t, std::shared_ptr<DeviceStorageSlot>> storage_slots_;
 
         // Lock to protect access to the data stream map
         std::mutex data_stream_map_mtx_;
-        // Storage for the mapping between tracking devices' hash and their data stream pointer.
-        std::unordered_map<uint64_t, rpcClientCallData*> device_data_streams_;
+        // Storage for the mapping between tracking devices' hash and the shared data stream they are received from.
+        std::unordered_map<uint64_t, std::shared_ptr<SharedDeviceDataStream>> device_data_streams_;
 
-        // The associated data frame stream pointer. There can only be one DataFrame request associated with a DataManager
+        // The associated data frame stream pointer. There can only be one DataFrame request associated with a DataManager,
+        // plus a pending stream replacing it. Frames are accepted from the stream of the current generation only.
+        // Both streams are pinned to the same completion queue, so their frames are never processed concurrently.
         std::mutex dataframe_stream_mtx_;
         rpcClientCallData* dataframe_stream_ = nullptr;
+        uint64_t dataframe_stream_generation_ = 0;
+        rpcClientCallData* pending_dataframe_stream_ = nullptr;
+        uint64_t pending_dataframe_stream_generation_ = 0;
+        // Generation 0 means no stream
+        uint64_t next_dataframe_stream_generation_ = 1;
 
         // The device data callback function provided by user.
         std::function<void(const api::TrackingDeviceData& packet)> device_data_user_callback_;
@@ -117,6 +205,23 @@ namespace ommo
         // request_ and stream_typs_ are initialized when DataManager is created.
         api::DataRequest request_;
         const api::DataStreamType stream_type_;
+        // DeviceDataPart flags of request_, the parts converted and stored for every device
+        const uint32_t device_data_parts_;
+        // Storage options of the devices
+        const bool store_columnar_history_;
+        const bool convert_on_read_;
+
+        // Hashes of request_.requested_devices for constant time lookup
+        std::unordered_set<uint64_t> requested_device_hashes_;
+
+        // Lock to protect the callback dispatchers and their lanes
+        std::shared_mutex dispatch_mtx_;
+        // Each device is fed by a single stream, so every device gets its own single producer lane
+        std::unordered_map<uint64_t, std::shared_ptr<DeviceDataDispatcher::Lane>> device_data_lanes_;
+        std::shared_ptr<DataFrameDispatcher::Lane> data_frame_lane_;
+        // Declared last so the executor threads are stopped before anything they use is destroyed
+        std::unique_ptr<DeviceDataDispatcher> device_data_dispatcher_;
+        std::unique_ptr<DataFrameDispatcher> data_frame_dispatcher_;
     };
 
 }  // namespace ommo
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "sdk_types.h"
+
+namespace ommo
+{
+    /*
+     * Optional parts of a TrackingDeviceData. A stream only delivers the parts its DataRequest asks for, so the
+     * converters, the wire decoder and the storage skip the others instead of walking and storing empty fields.
+     * Poses and latency timestamps are always delivered. Unrequested parts read as absent: no raw sensor data or
+     * buttons, and a battery state of -1.
+     */
+    enum DeviceDataPart : uint32_t
+    {
+        kDeviceDataRawSensorData = (1 << 0),
+        kDeviceDataButtons = (1 << 1),
+        kDeviceDataBatteryState = (1 << 2),
+        kAllDeviceDataParts = kDeviceDataRawSensorData | kDeviceDataButtons | kDeviceDataBatteryState
+    };
+
+    inline uint32_t RequestedDeviceDataParts(uint32_t data_field_mask, bool include_raw_sensor_data)
+    {
+        return (include_raw_sensor_data ? static_cast<uint32_t>(kDeviceDataRawSensorData) : 0u) |
+            ((data_field_mask & api::kButtonStatus) != 0 ? static_cast<uint32_t>(kDeviceDataButtons) : 0u) |
+            ((data_field_mask & api::kBatteryStatus) != 0 ? static_cast<uint32_t>(kDeviceDataBatteryState) : 0u);
+    }
+
+    inline uint32_t RequestedDeviceDataParts(const api::DataRequest& request)
+    {
+        return RequestedDeviceDataParts(request.data_field_mask, request.include_raw_sensor_data);
+    }
+}  // namespace ommo
@@ -9,45 +9,258 @@
 #pragma once
 
 #include <atomic>
-#include <shared_mutex>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "columnar_history.h"
 #include "sdk_types.h"
 #include "ommo_service_api.pb.h"
+#include "wire_decoder.h"
 
 namespace ommo
 {
-    class DeviceDataStorage
+    /*
+     * Ring buffer holding the latest buffer_size packets of a device.
+     *
+     * PushData and PushEncodedData must only be called from one thread at a time. Readers never block the writer and the writer never
+     * waits on readers: every slot carries a sequence number that readers validate before and after copying a packet,
+     * and packets overwritten while being copied are skipped.
+     *
+     * With convert_on_read, packets pushed with PushEncodedData are kept encoded and only converted when they are
+     * read. The converted packet is kept per slot, so reading a packet again does not convert it again. Readers
+     * converting a packet serialize on a mutex the writer never takes.
+     */
+    class DeviceDataStorage : public std::enable_shared_from_this<DeviceDataStorage>
     {
     private:
-        struct BufferInfo
+        // Member array of a slot. Points into the storage slab unless the slot had to grow past its slab capacity.
+        template <typename T>
+        struct SlotArray
         {
-            std::atomic_int32_t data_num;
-            api::DevicePacket* packet_buffer_ptr;
+            T* data = nullptr;
+            uint32_t capacity = 0;
+            std::unique_ptr<T[]> overflow;
         };
 
-        void SwitchBufferPointer();
+        // State of a ring slot. The packet itself is stored at the same index in packets_.
+        // seq is odd while the slot is being written and 2 * (position + 1) once it holds the packet at <position>.
+        struct Slot
+        {
+            std::atomic<uint64_t> seq{ 0 };
+
+            // Backing memory of the member arrays of the packet
+            SlotArray<api::RawSensorData> raw_sensor_data;
+            SlotArray<api::PoseData> poses;
+            SlotArray<api::ButtonState> buttons;
+            SlotArray<api::TimestampData> latency_timestamps;
+
+            // Member counts of the packet. The copy in packets_ is clamped to the slab capacities, see PublishSlotHeader.
+            uint32_t raw_sensor_data_count = 0;
+            uint32_t pose_count = 0;
+            uint32_t button_count = 0;
+            uint32_t latency_timestamp_count = 0;
+
+            // Encoded packet of a slot written with convert_on_read. Unset if the packet in packets_ is converted.
+            bool is_encoded = false;
+            SlotArray<uint8_t> encoded;
+            uint32_t encoded_size = 0;
+        };
+
+        // Packet converted from an encoded slot by a reader. seq matches the slot sequence of the converted packet.
+        // seq and device_data are only accessed while holding decode_mtx_.
+        struct DecodedSlot
+        {
+            std::atomic<uint64_t> seq{ 0 };
+            api::TrackingDeviceData device_data{};
+
+            SlotArray<api::RawSensorData> raw_sensor_data;
+            SlotArray<api::PoseData> poses;
+            SlotArray<api::ButtonState> buttons;
+            SlotArray<api::TimestampData> latency_timestamps;
+        };
+
+        // Arrays replaced by bigger ones. Readers may still be copying from them, so they are only freed with the storage.
+        using RetiredArrays = std::vector<std::shared_ptr<void>>;
+
+        // Packets covered by a borrowed view. The ring may wrap, in which case the view continues at index 0.
+        struct ViewWindow
+        {
+            uint64_t first_position;
+            uint64_t count;
+            uint32_t first_index;
+            uint32_t first_count;
+            uint32_t wrapped_count;
+        };
+
+        // Window over the most recent <count> packets that can safely be borrowed
+        ViewWindow GetLatestViewWindow(uint32_t count) const;
+
+        // Contiguous backing memory for one member array of every slot, <capacity> elements per slot
+        template <typename T>
+        struct Slab
+        {
+            std::unique_ptr<T[]> data;
+            uint32_t capacity = 0;
+        };
+
+        // Point the slot array of every slot at its part of the slab
+        template <typename T>
+        void AssignSlab(Slab<T>& slab, uint32_t capacity, SlotArray<T> Slot::* slot_array);
+
+        // Make sure a slot array can hold <required> elements. Only allocates if the packet exceeds the slab capacity.
+        template <typename T>
+        static void ReserveSlotArray(SlotArray<T>& array, uint32_t required, RetiredArrays& retired_arrays);
+
+        // Fill the slot at <index> with the packet. Must only be called by the writer while the slot sequence is odd.
+        void WriteSlot(uint32_t index, const ommo::TrackingDeviceData& packet);
+        void WriteSlot(uint32_t index, const api::TrackingDeviceData& packet);
+
+        // Decode an encoded packet into the arrays of spare_slot_. Returns false if the data is malformed, in which
+        // case the ring is left untouched.
+        bool DecodeSpareSlot(const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout, api::TrackingDeviceData& device_data);
+        // Move the packet decoded by DecodeSpareSlot into the slot at <index> by swapping their arrays. Must only be
+        // called by the writer while the slot sequence is odd.
+        void WriteSpareSlot(uint32_t index, const api::TrackingDeviceData& device_data);
+
+        // Point the members of <data> to the arrays of <slot>, grown to hold the given member counts
+        void PrepareSlot(Slot& slot, uint32_t raw_sensor_data_count, uint32_t pose_count, uint32_t button_count, uint32_t latency_timestamp_count,
+            api::TrackingDeviceData& data);
+        // Store the header of the packet written to the slot at <index> in packets_
+        void PublishSlotHeader(uint32_t index, const api::TrackingDeviceData& data);
+
+        // Keep the encoded packet in the slot at <index> to convert it when it is read
+        void WriteEncodedSlot(uint32_t index, const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout);
+
+        // Add the packet written to the slot at <index> to the time index and the columnar history
+        void IndexSlot(uint32_t index, const api::TrackingDeviceData& data);
+        // Add the times of the packet written to the slot at <index> to the time index. A device timestamp behind the
+        // previous one starts a new device time epoch.
+        void ExtendTimeIndex(uint32_t index, uint32_t timestamp, uint64_t sample_time);
+
+        // Mark the slot of the next position as being written. Returns the position.
+        uint64_t BeginSlotWrite();
+        // Publish the slot written at <position>
+        void FinishSlotWrite(uint64_t position);
+
+        // Copy the packet index and data header of the packet at <position>. The member pointers still point into the slot.
+        // Returns false if the packet is not stored (anymore).
+        bool ReadPacketHeader(uint64_t position, uint32_t& packet_idx, api::TrackingDeviceData& header) const;
+
+        // Copy the data header of the encoded packet at <position>, converting the packet first unless that was already
+        // done. The member pointers point into the decoded slot. Returns false if the packet is not stored (anymore).
+        bool ReadDecodedHeader(uint64_t position, api::TrackingDeviceData& header) const;
+        // Convert the encoded packet at <position> into its decoded slot. Must be called with decode_mtx_ held.
+        bool DecodeSlot(uint64_t position) const;
+
+        // Check that the slot of <position> still holds the packet
+        bool IsPacketStored(uint64_t position) const;
+
+        // Copy the packet at <position> into <packet>. Returns false if the packet is not stored (anymore).
+        bool ReadPacket(uint64_t position, api::DevicePacket& packet) const;
+
+        // Copy the packet at <position> into the caller owned member arrays of <packet>, truncating members to the
+        // capacities of <buffer>. <truncated> tells whether any were. Returns false if the packet is not stored (anymore).
+        bool ReadPacket(uint64_t position, api::DevicePacket& packet, const api::DevicePacketBuffer& buffer, bool& truncated) const;
+
+        // Copy the packets at positions [first, end). Packets overwritten while copying are left out.
+        api::DataResponseUPtr ReadPackets(uint64_t first, uint64_t end) const;
+        api::DataResponseState ReadPackets(uint64_t first, uint64_t end, api::DevicePacketBuffer& buffer) const;
+
+        // Find the position of the packet with <start_idx>. Returns false if the packet has not been received yet.
+        // If the packet was already overwritten, <first> is the oldest stored position and <complete> is set to false.
+        bool FindPositionSinceIndex(uint64_t head, uint32_t start_idx, uint64_t& first, bool& complete) const;
+
+        // Read the index time of the packet at <position>. Returns false if the packet is not stored (anymore).
+        bool ReadIndexTime(uint64_t position, api::TimeBase time_base, uint64_t& time) const;
+
+        // Convert a query time to the index time. Device timestamps are unwrapped relative to the latest packet.
+        uint64_t ToIndexTime(api::TimeBase time_base, uint64_t time, uint64_t head) const;
+
+        // Oldest position searched by time queries with <time_base>
+        uint64_t OldestSearchedPosition(api::TimeBase time_base, uint64_t head) const;
+
+        // First position in [first, end) with an index time at or after <time>, or <end> if there is none.
+        // Packets overwritten during the search count as older than any time.
+        uint64_t LowerBoundTime(api::TimeBase time_base, uint64_t time, uint64_t first, uint64_t end) const;
+
+        // Position of the first packet to read with <cursor>. Counts the packets the cursor missed as lost.
+        uint64_t StartCursorRead(api::DataCursor& cursor, uint64_t head) const;
+        // Count the packets between <first> and <end> that were not read as lost and move the cursor to <end>
+        void FinishCursorRead(api::DataCursor& cursor, uint64_t first, uint64_t end, uint32_t read_count) const;
 
         const api::DeviceDescriptorUPtr device_;
         uint32_t buffer_size_;
 
-        // Record the packet index.
-        uint32_t packet_received_num_;
+        std::unique_ptr<Slot[]> slots_;
+
+        // Stored packets. Kept apart from the slot state so borrowed views can expose them as contiguous arrays.
+        // The member pointers of each packet point into the arrays of its slot.
+        std::unique_ptr<api::DevicePacket[]> packets_;
 
-        // Use DevicePacketUPtr so memory clean up on destruction happens properly
-        api::DevicePacket* packet_buffer1_;
-        api::DevicePacket* packet_buffer2_;
+        // Preallocated member arrays of all slots, sized from the device descriptor so pushes do not allocate
+        Slab<api::RawSensorData> raw_sensor_data_slab_;
+        Slab<api::PoseData> pose_slab_;
+        Slab<api::ButtonState> button_slab_;
+        Slab<api::TimestampData> latency_timestamp_slab_;
 
-        BufferInfo read_buffer_;
-        BufferInfo write_buffer_;
-        std::shared_mutex switch_mutex_;
+        // Arrays encoded packets are decoded into before they enter the ring, so a malformed packet does not destroy
+        // the oldest stored one. At least as large as the slab parts, see PublishSlotHeader.
+        Slot spare_slot_;
+
+        // Time index, one entry per slot. Device timestamps are unwrapped to 64 bit and packets without a sample
+        // timestamp reuse the previous one, so both times never decrease with the position and can be binary searched.
+        std::unique_ptr<uint64_t[]> device_times_;
+        std::unique_ptr<uint64_t[]> sample_times_;
+        // Times of the latest packet. Only used by the writer.
+        uint64_t last_device_time_ = 0;
+        uint64_t last_sample_time_ = 0;
+        // First position of the current device time epoch. Device time queries do not search older packets.
+        // Published to readers by head_.
+        std::atomic<uint64_t> device_time_epoch_start_{ 0 };
+
+        // Optional columnar copy of the stored packets, rows match the slot indices
+        std::unique_ptr<ColumnarHistory> history_;
+
+        // DeviceDataPart flags the stream delivers. The other parts are neither converted nor stored.
+        const uint32_t device_data_parts_;
+
+        // Keep encoded packets encoded until they are read
+        bool convert_on_read_ = false;
+        // Preallocated encoded packet bytes of all slots, only used with convert_on_read
+        Slab<uint8_t> encoded_slab_;
+        // Packets converted by readers, one per slot. Only allocated with convert_on_read.
+        std::unique_ptr<DecodedSlot[]> decoded_;
+        // Serializes the readers converting packets. Protects decoded_ headers, decode_buffer_ and decoded_retired_arrays_.
+        mutable std::mutex decode_mtx_;
+        // Copy of the encoded packet being converted, so the writer can reuse the slot meanwhile
+        mutable std::vector<uint8_t> decode_buffer_;
+        mutable RetiredArrays decoded_retired_arrays_;
+
+        // Number of packets pushed so far. The packet at position p is stored in slot p % buffer_size_.
+        std::atomic<uint64_t> head_{ 0 };
+
+        // Overflow arrays of the slots replaced by bigger ones
+        RetiredArrays retired_arrays_;
 
     public:
-        DeviceDataStorage(const api::DeviceDescriptor& device, uint32_t buffer_size);
-        ~DeviceDataStorage();
+        // convert_on_read is ignored together with store_columnar_history, which needs every packet converted.
+        // Slots only preallocate the DeviceDataPart flags in <device_data_parts>, see RequestedDeviceDataParts.
+        DeviceDataStorage(const api::DeviceDescriptor& device, uint32_t buffer_size, bool store_columnar_history = false, bool convert_on_read = false,
+            uint32_t device_data_parts = kAllDeviceDataParts);
+        ~DeviceDataStorage() = default;
 
         uint32_t GetUUID() const;
         uint32_t GetPortId() const;
 
         bool PushData(const ommo::TrackingDeviceData& m);
+        // Store a packet that was already converted by copying it into the ring slot
+        bool PushData(const api::TrackingDeviceData& packet);
+
+        // Store a packet received as an encoded ommo::TrackingDeviceData, decoding it straight into the ring slot or
+        // keeping it encoded with convert_on_read. <layout> must be scanned from the same bytes.
+        // Returns false if the packet is malformed or of another device.
+        bool PushEncodedData(const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout);
+        bool PushEncodedData(const uint8_t* data, size_t size);
 
         // Return the most recent packet.
         api::DataResponseUPtr GetLatestData();
@@ -55,9 +268,63 @@ namespace ommo
         // Return the most recent <count> packets.
         api::DataResponseUPtr GetLatestData(uint32_t count);
 
-        // TODO: This function currently does not handle when packet_idx wraps
-        // TODO: Implement proper wrapping handling when packet_idx overflows uint32
-        // Return all packets starting from start_idx;
+        // Return all packets starting from start_idx.
+        // packet_idx wraps at 2^32. start_idx is matched against the packets within 2^31 packets before the latest one,
+        // any other start_idx is treated as a packet that has not been received yet.
         api::DataResponseUPtr GetDataSinceIndex(uint32_t start_idx);
+
+        // Buffer variants of the functions above. They copy into the caller owned buffer and do not allocate.
+        // GetLatestData keeps the newest packets and GetDataSinceIndex the oldest ones if the buffer is too small.
+        api::DataResponseState GetLatestData(uint32_t count, api::DevicePacketBuffer& buffer);
+        api::DataResponseState GetDataSinceIndex(uint32_t start_idx, api::DevicePacketBuffer& buffer);
+
+        // Position of the next packet that will be stored
+        uint64_t GetHeadPosition() const;
+
+        // Return the packets stored since the last read with <cursor> and advance it past them.
+        // Only touches the new packets, so the cost does not depend on the buffer size.
+        api::DataResponseUPtr ReadNewData(api::DataCursor& cursor) const;
+        // Buffer variant. If the buffer is too small, the cursor stops after the last copied packet.
+        api::DataResponseState ReadNewData(api::DataCursor& cursor, api::DevicePacketBuffer& buffer) const;
+
+        // Borrow the most recent <count> packets without copying. The view keeps the storage alive until it is destroyed.
+        // The writer does not wait for views, use IsDataViewValid to check that none of the packets was overwritten.
+        // The storage must be owned by a shared_ptr. Returns kNoData with convert_on_read, packets are not converted in place.
+        api::DataViewUPtr GetLatestDataView(uint32_t count) const;
+
+        // Return the packets with an index time within [start_time, end_time].
+        api::DataResponseUPtr GetDataInTimeRange(api::TimeBase time_base, uint64_t start_time, uint64_t end_time) const;
+
+        // Return the packet with the index time closest to <time>.
+        api::DataResponseUPtr GetNearestSample(api::TimeBase time_base, uint64_t time) const;
+
+        // Borrow the columns of the most recent <count> packets of a sensor unit. Returns kNoData if the storage
+        // has no columnar history. Validated with IsViewValid like a data view.
+        api::HistoryViewUPtr GetHistoryView(uint32_t sensor_unit_index, uint32_t count) const;
+
+        // Check that the <count> packets viewed starting at <first_position> have not been overwritten yet.
+        bool IsViewValid(uint64_t first_position, uint64_t count) const;
     };
+
+    // Guard stored in api::DataView. Keeps the viewed storage alive and identifies the viewed packets.
+    struct DataViewGuard
+    {
+        std::shared_ptr<const DeviceDataStorage> storage;
+        uint64_t first_position;
+        uint64_t packet_count;
+    };
+
+    /*
+     * Storage of a device as seen by the streams feeding it. Streams resolve the slot once when they are opened, so
+     * packets reach the storage without a map lookup or lock. The slot outlives the storage: it is emptied when the
+     * storage is removed and refilled when the storage is created again. Packets for an empty slot are dropped.
+     */
+    struct DeviceStorageSlot
+    {
+        // Read and replaced with std::atomic_load and std::atomic_store
+        std::shared_ptr<DeviceDataStorage> storage;
+    };
+
+    // Storage slots of the devices of a data frame stream by device key, in the order the devices were requested
+    using DeviceStorageSlotTable = std::vector<std::pair<uint64_t, std::shared_ptr<DeviceStorageSlot>>>;
 }  // namespace ommo
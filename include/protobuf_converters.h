@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "device_data_parts.h"
 #include "sdk_types.h"
 #include "ommo_service_api.pb.h"
 
@@ -74,11 +75,30 @@ namespace ommo
     // Convert from ommo::BatteryState protobuf to ommo::api::BatteryState struct
     api::BatteryState ProtoToBatteryInfo(const ommo::BatteryState& battery_state);
 
-    // Convert from ommo::TrackingDeviceData protobuf to ommo::api::TrackingDeviceData struct
-    api::TrackingDeviceDataUPtr ProtoToTrackingDeviceData(const ommo::TrackingDeviceData& data);
+    // Convert from ommo::TrackingDeviceData protobuf to ommo::api::TrackingDeviceData struct.
+    // Only the DeviceDataPart flags in <parts> are converted, the other parts are left absent.
+    api::TrackingDeviceDataUPtr ProtoToTrackingDeviceData(const ommo::TrackingDeviceData& data, uint32_t parts = kAllDeviceDataParts);
+
+    // Fill an existing ommo::api::TrackingDeviceData struct from ommo::TrackingDeviceData protobuf.
+    // The member arrays must already be allocated and large enough to hold the elements of data, see DeviceDataCounts.
+    void ProtoToTrackingDeviceData(const ommo::TrackingDeviceData& data, api::TrackingDeviceData& tracking_device_data, uint32_t parts = kAllDeviceDataParts);
+
+    // Member array sizes of ommo::TrackingDeviceData protobuf when converting <parts>
+    struct DeviceDataCounts
+    {
+        uint32_t raw_sensor_data_count;
+        uint32_t pose_count;
+        uint32_t button_count;
+        uint32_t latency_timestamp_count;
+    };
+    DeviceDataCounts GetDeviceDataCounts(const ommo::TrackingDeviceData& data, uint32_t parts);
 
     // Convert from ommo::DataFrame protobuf to ommo::api::DataFrame struct
-    api::DataFrameUPtr ProtoToDataFrame(const ommo::DataFrame& frame);
+    api::DataFrameUPtr ProtoToDataFrame(const ommo::DataFrame& frame, uint32_t parts = kAllDeviceDataParts);
+
+    // Same as above, converting into an immutable packet that can be shared
+    api::TrackingDeviceDataSPtr ProtoToSharedTrackingDeviceData(const ommo::TrackingDeviceData& data, uint32_t parts = kAllDeviceDataParts);
+    api::DataFrameSPtr ProtoToSharedDataFrame(const ommo::DataFrame& frame, uint32_t parts = kAllDeviceDataParts);
 
     // Convert from ommo::DeviceFusionMode protobuf enum to ommo::api::DeviceFusionMode enum
     api::DeviceFusionMode ProtoToDeviceFusionMode(const ommo::DeviceFusionMode& fusion_mode);
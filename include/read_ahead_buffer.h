@@ -0,0 +1,124 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "google/protobuf/arena.h"
+#include "google/protobuf/stubs/common.h"
+
+namespace ommo
+{
+    /*
+     * Rotating response slots for a streaming call data.
+     *
+     * gRPC allows a single outstanding Read per stream. With more than one slot the next Read can be issued into a
+     * free slot as soon as a Read completes, so the stream keeps receiving while the completed message is delivered.
+     * A slot returned by CompleteRead stays valid until the next call to CompleteRead.
+     */
+    template <typename T, size_t SlotCount = 2>
+    class ReadAheadBuffer
+    {
+        static_assert(SlotCount >= 2, "Read-ahead needs at least two slots");
+
+    public:
+        // Slot to pass to the next Read
+        T* NextReadSlot()
+        {
+            return &slots_[read_idx_];
+        }
+
+        // Mark the outstanding Read as completed. Returns the slot holding the received message and moves on to the next slot.
+        T& CompleteRead()
+        {
+            T& completed = slots_[read_idx_];
+            read_idx_ = (read_idx_ + 1) % SlotCount;
+            return completed;
+        }
+
+    private:
+        std::array<T, SlotCount> slots_;
+        size_t read_idx_ = 0;
+    };
+
+    /*
+     * ReadAheadBuffer for protobuf messages that are parsed into a per-slot Arena.
+     *
+     * Each slot keeps an arena message that is reused for its Reads, so protobuf reuses the repeated sub-messages of
+     * the previous response like it does for a heap message. Sub-messages protobuf does not reuse are bump allocated
+     * from a preallocated block instead of the heap. Once half of the block is used, the arena is reset and a new
+     * message is created right before the slot is handed out for the next Read, so parsing never allocates from the
+     * heap as long as a single response fits into the other half. The same validity rule as ReadAheadBuffer applies.
+     */
+    template <typename T, size_t SlotCount = 2, size_t InitialBlockSize = 256 * 1024>
+    class ArenaReadAheadBuffer
+    {
+        static_assert(SlotCount >= 2, "Read-ahead needs at least two slots");
+
+    public:
+        ArenaReadAheadBuffer()
+        {
+            for (Slot& slot : slots_)
+            {
+                slot.block = std::make_unique<char[]>(InitialBlockSize);
+                google::protobuf::ArenaOptions options;
+                options.initial_block = slot.block.get();
+                options.initial_block_size = InitialBlockSize;
+                options.start_block_size = InitialBlockSize;
+                slot.arena = std::make_unique<google::protobuf::Arena>(options);
+            }
+        }
+
+        ArenaReadAheadBuffer(const ArenaReadAheadBuffer&) = delete;
+        ArenaReadAheadBuffer& operator=(const ArenaReadAheadBuffer&) = delete;
+
+        // Message to pass to the next Read. Resets the arena of the slot first if its block is half used.
+        T* NextReadSlot()
+        {
+            Slot& slot = slots_[read_idx_];
+            if (slot.message != nullptr && slot.arena->SpaceUsed() <= InitialBlockSize / 2)
+            {
+                return slot.message;
+            }
+
+            slot.arena->Reset();
+#if GOOGLE_PROTOBUF_VERSION >= 5026000
+            slot.message = google::protobuf::Arena::Create<T>(slot.arena.get());
+#else
+            // Older Arena::Create places the message on the arena without making it arena aware, so its
+            // sub-messages would still be heap allocated
+            slot.message = google::protobuf::Arena::CreateMessage<T>(slot.arena.get());
+#endif
+            return slot.message;
+        }
+
+        // Mark the outstanding Read as completed. Returns the message received into the slot and moves on to the next slot.
+        T& CompleteRead()
+        {
+            T& completed = *slots_[read_idx_].message;
+            read_idx_ = (read_idx_ + 1) % SlotCount;
+            return completed;
+        }
+
+    private:
+        struct Slot
+        {
+            // Declared before the arena so the arena is destroyed first
+            std::unique_ptr<char[]> block;
+            std::unique_ptr<google::protobuf::Arena> arena;
+            // Owned by arena
+            T* message = nullptr;
+        };
+
+        std::array<Slot, SlotCount> slots_;
+        size_t read_idx_ = 0;
+    };
+}  // namespace ommo
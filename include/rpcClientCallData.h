@@ -42,7 +42,7 @@ class rpcClientCallData
 {
 public:
     rpcClientCallData(
-        std::shared_ptr<Channel> channel, 
+        std::shared_ptr<ommo::CoreService::Stub> stub, 
         CompletionQueue* cq, 
         ClientCallState status, 
         std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{}
@@ -59,8 +59,8 @@ protected:
     CompletionQueue* completion_queue;
     ClientContext grpc_client_context;
     ClientCallState status;
-    std::shared_ptr<Channel> channel;
-    std::unique_ptr<ommo::CoreService::Stub> stub;
+    // Stub shared by all call data of a ClientManager. Keeps the channel alive for as long as the call is running.
+    std::shared_ptr<ommo::CoreService::Stub> stub;
     rwlock statusLock = RWLOCK_INIT_VAL;
 
     // Store each internal tag type so that we can distinguish what event is being returned
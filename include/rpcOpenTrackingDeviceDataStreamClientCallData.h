@@ -10,6 +10,7 @@
 
 #include "grpcpp/grpcpp.h"
 #include "ommo_service_api.grpc.pb.h"
+#include "read_ahead_buffer.h"
 #include "rpcClientCallData.h"
 
 using grpc::ClientAsyncReader;
@@ -18,7 +19,7 @@ class rpcOpenTrackingDeviceDataStreamClientCallData : public rpcClientCallData
 {
 public:
     rpcOpenTrackingDeviceDataStreamClientCallData(
-        std::shared_ptr<Channel> channel, 
+        std::shared_ptr<ommo::CoreService::Stub> stub, 
         CompletionQueue* cq, 
         const ommo::TrackingDeviceDataStreamRequest &request, 
         const std::function<void(const ommo::TrackingDeviceData&)> cb_handler, 
@@ -28,6 +29,8 @@ public:
 
 private:
     const std::function<void(const ommo::TrackingDeviceData&)> cb_handler_;
-    ommo::TrackingDeviceData response_;
+    // Double buffered so the next Read is outstanding while the previous message is delivered.
+    // Each response is parsed into the arena of its slot, which is reset when the slot is reused.
+    ommo::ArenaReadAheadBuffer<ommo::TrackingDeviceData, 2, 16 * 1024> responses_;
     std::unique_ptr<ClientAsyncReader<ommo::TrackingDeviceData>> reader_;
 };
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "grpcpp/grpcpp.h"
 #include "ommo_service_api.grpc.pb.h"
+#include "read_ahead_buffer.h"
 #include "rpcClientCallData.h"
 
 using grpc::ClientAsyncReader;
@@ -18,7 +19,7 @@ class rpcOpenTrackingDevicesEventStreamClientCallData : public rpcClientCallData
 {
 public:
     rpcOpenTrackingDevicesEventStreamClientCallData(
-        std::shared_ptr<Channel> channel, 
+        std::shared_ptr<ommo::CoreService::Stub> stub, 
         CompletionQueue* cq, 
         const ommo::TrackingDevicesEventStreamRequest & request, 
         const std::function<void(const ommo::TrackingDeviceEvent&)> cb_handler
@@ -27,6 +28,7 @@ public:
 
 private:
     const std::function<void(const ommo::TrackingDeviceEvent&)> cb_handler_;
-    ommo::TrackingDeviceEvent response_;
+    // Double buffered so the next Read is outstanding while the previous message is delivered
+    ommo::ReadAheadBuffer<ommo::TrackingDeviceEvent> responses_;
     std::unique_ptr<ClientAsyncReader<ommo::TrackingDeviceEvent>> reader_;
 };
\ No newline at end of file
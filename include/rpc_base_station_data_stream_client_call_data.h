@@ -10,6 +10,7 @@
 
 #include "grpcpp/grpcpp.h"
 #include "ommo_service_api.grpc.pb.h"
+#include "read_ahead_buffer.h"
 #include "rpcClientCallData.h"
 
 using grpc::ClientAsyncReader;
@@ -18,7 +19,7 @@ class RpcBaseStationDataStreamClientCallData : public rpcClientCallData
 {
 public:
     RpcBaseStationDataStreamClientCallData(
-        std::shared_ptr<Channel> channel, 
+        std::shared_ptr<ommo::CoreService::Stub> stub, 
         CompletionQueue* cq, 
         const ommo::BaseStationDataStreamRequest &request, 
         const std::function<void(const ommo::BaseStationData&)> cb_handler, 
@@ -28,6 +29,7 @@ public:
 
 private:
     const std::function<void(const ommo::BaseStationData&)> cb_handler_;
-    ommo::BaseStationData response_;
+    // Double buffered so the next Read is outstanding while the previous message is delivered
+    ommo::ReadAheadBuffer<ommo::BaseStationData> responses_;
     std::unique_ptr<ClientAsyncReader<ommo::BaseStationData>> reader_;
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "grpcpp/generic/generic_stub.h"
+#include "grpcpp/grpcpp.h"
+#include "ommo_service_api.grpc.pb.h"
+#include "read_ahead_buffer.h"
+#include "rpcClientCallData.h"
+
+/*
+ * Server streaming call made through the generic stub. Responses are not parsed, the listener receives the encoded
+ * message bytes of each response and decodes what it needs itself.
+ *
+ * The generic stub only offers bidirectional calls, so the request is sent as the last message of the call once it
+ * has started and reading begins once the request is written. Only one operation is outstanding at any time.
+ */
+class RpcEncodedStreamClientCallData : public rpcClientCallData
+{
+public:
+    RpcEncodedStreamClientCallData(
+        std::shared_ptr<ommo::CoreService::Stub> stub, 
+        std::shared_ptr<grpc::GenericStub> generic_stub, 
+        CompletionQueue* cq, 
+        const std::string& method, 
+        const google::protobuf::Message& request, 
+        const std::function<void(const uint8_t*, size_t)> cb_handler, 
+        std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{}
+    );
+
+    bool Proceed(OperationType op_type);
+
+private:
+    const std::function<void(const uint8_t*, size_t)> cb_handler_;
+    // Keeps the channel of the generic stream alive for as long as the call is running
+    std::shared_ptr<grpc::GenericStub> generic_stub_;
+    grpc::ByteBuffer request_;
+    // Double buffered so the next Read is outstanding while the previous message is delivered
+    ommo::ReadAheadBuffer<grpc::ByteBuffer> responses_;
+    std::unique_ptr<grpc::GenericClientAsyncReaderWriter> stream_handler_;
+};
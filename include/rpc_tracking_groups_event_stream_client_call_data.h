@@ -10,6 +10,7 @@
 
 #include "grpcpp/grpcpp.h"
 #include "ommo_service_api.grpc.pb.h"
+#include "read_ahead_buffer.h"
 #include "rpcClientCallData.h"
 
 using grpc::ClientAsyncReader;
@@ -18,7 +19,7 @@ class RpcTrackingGroupsEventStreamClientCallData : public rpcClientCallData
 {
 public:
     RpcTrackingGroupsEventStreamClientCallData(
-        std::shared_ptr<Channel> channel, 
+        std::shared_ptr<ommo::CoreService::Stub> stub, 
         CompletionQueue* cq, 
         const ommo::TrackingGroupsEventStreamRequest &request, 
         const std::function<void(const ommo::TrackingGroupEvent&)> cb_handler
@@ -27,6 +28,7 @@ public:
 
 private:
     const std::function<void(const ommo::TrackingGroupEvent&)> cb_handler_;
-    ommo::TrackingGroupEvent response_;
+    // Double buffered so the next Read is outstanding while the previous message is delivered
+    ommo::ReadAheadBuffer<ommo::TrackingGroupEvent> responses_;
     std::unique_ptr<ClientAsyncReader<ommo::TrackingGroupEvent>> reader_;
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+#include "grpcpp/grpcpp.h"
+#include "ommo_service_api.grpc.pb.h"
+#include "rpcClientCallData.h"
+
+/*
+ * Call data for an asynchronous unary RPC.
+ *
+ * The call is started on construction and cb_handler is called once from the completion queue thread with the
+ * final status and response. The call data is deleted by the completion queue processor afterwards.
+ */
+template <typename Request, typename Response>
+class RpcUnaryClientCallData : public rpcClientCallData
+{
+public:
+    using PrepareFunction = std::unique_ptr<ClientAsyncResponseReader<Response>> (ommo::CoreService::Stub::*)(ClientContext*, const Request&, CompletionQueue*);
+
+    // A timeout_ms of 0 means the call has no deadline
+    RpcUnaryClientCallData(
+        std::shared_ptr<ommo::CoreService::Stub> stub,
+        CompletionQueue* cq,
+        PrepareFunction prepare_function,
+        const Request& request,
+        uint32_t timeout_ms,
+        const std::function<void(const Status&, Response&)> cb_handler,
+        std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{}
+    )
+        : rpcClientCallData(stub, cq, ClientCallState::PROCESSING, association), cb_handler_(cb_handler)
+    {
+        // The deadline must be set before the call is prepared
+        if (timeout_ms > 0)
+        {
+            grpc_client_context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(timeout_ms));
+        }
+
+        reader_ = ((*stub).*prepare_function)(&grpc_client_context, request, completion_queue);
+        reader_->StartCall();
+        reader_->Finish(&response_, &call_status_, &finish_tag);
+    }
+
+    bool Proceed(OperationType op_type)
+    {
+        rwlock_wrlockguard lock(statusLock);
+
+        // Finish always completes successfully for unary calls. Treat anything else as an aborted call.
+        if (status == ClientCallState::FINISH)
+        {
+            call_status_ = Status(grpc::StatusCode::ABORTED, "Call did not complete");
+        }
+        status = ClientCallState::FINISH;
+
+        if (cb_handler_)
+        {
+            cb_handler_(call_status_, response_);
+        }
+
+        // The call is done, delete this object
+        return false;
+    }
+
+private:
+    const std::function<void(const Status&, Response&)> cb_handler_;
+    Response response_;
+    Status call_status_;
+    std::unique_ptr<ClientAsyncResponseReader<Response>> reader_;
+};
@@ -10,6 +10,7 @@
 
 #include "grpcpp/grpcpp.h"
 #include "ommo_service_api.grpc.pb.h"
+#include "read_ahead_buffer.h"
 #include "rpcClientCallData.h"
 
 using grpc::ClientAsyncReaderWriter;
@@ -18,7 +19,7 @@ class RpcWirelessManagementStreamClientCallData : public rpcClientCallData
 {
 public:
     RpcWirelessManagementStreamClientCallData(
-        std::shared_ptr<Channel> channel, 
+        std::shared_ptr<ommo::CoreService::Stub> stub, 
         CompletionQueue* cq, 
         const std::function<void(const ommo::WirelessManagementEvent&)> cb_handler, 
         std::weak_ptr<ommo::CallDataAssociation> association = std::weak_ptr<ommo::CallDataAssociation>{}
@@ -30,6 +31,7 @@ public:
 
 private:
     const std::function<void(const ommo::WirelessManagementEvent&)> cb_handler_;
-    ommo::WirelessManagementEvent response_;
+    // Double buffered so the next Read is outstanding while the previous message is delivered
+    ommo::ReadAheadBuffer<ommo::WirelessManagementEvent> responses_;
     std::unique_ptr<ClientAsyncReaderWriter<ommo::WirelessManagementRequest, ommo::WirelessManagementEvent>> stream_handler_;
 };
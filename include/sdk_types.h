@@ -76,6 +76,8 @@ namespace ommo::api
             uint64_t uuid;
         } SensorUnitDescriptor;
 
+        // sensor_unit_descriptors and supported_fusion_modes come from the SDK's pooled allocator when the library
+        // allocates them. Release them with DestroyDeviceDescriptorMembers, not delete[].
         typedef struct DeviceDescriptor
         {
             uint32_t siu_uuid;
@@ -169,6 +171,8 @@ namespace ommo::api
             uint32_t connected_siu_count;
         } WirelessReceiverHardwareState;
 
+        // The state arrays are pooled when allocated by the library and every state owns its members. Release the states
+        // with DestroyHardwareStates.
         typedef struct HardwareStates
         {
             BasestationHardwareState* basestation_states;
@@ -228,6 +232,8 @@ namespace ommo::api
             int32_t remaining_capacity;
         } BatteryState;
 
+        // The member arrays of device data allocated by the library share one pooled block. Release them with
+        // DestroyTrackingDeviceDataMembers, which also accepts arrays the caller allocated with new[].
         typedef struct TrackingDeviceData
         {
             uint32_t siu_uuid;
@@ -246,6 +252,7 @@ namespace ommo::api
             BatteryState battery_state;
         } TrackingDeviceData;
 
+        // device_data is a pooled array when allocated by the library, release the frame with DestroyDataFrame
         typedef struct DataFrame
         {
             TrackingDeviceData* device_data;
@@ -267,6 +274,16 @@ namespace ommo::api
             kSuccess
         } DataResponseState;
 
+        typedef enum TimeBase
+        {
+            // TrackingDeviceData::timestamp. Wrapping of the timestamp is resolved relative to the latest packet.
+            // Packets received before the timestamp stepped back, e.g. after a device reset, are not searched.
+            kTimeBaseDeviceTimestamp = 0,
+            // steady_timestamp_milliseconds of the kTimestampTypeSample latency timestamp
+            kTimeBaseSampleSteadyMilliseconds = 1
+        } TimeBase;
+
+        // packets is a pooled array when allocated by the library, release the response with DestroyDataResponse
         typedef struct DataResponse
         {
             DataResponseState state;
@@ -274,6 +291,108 @@ namespace ommo::api
             uint32_t packet_count;
         } DataResponse;
 
+        /*
+         * Read-only view of stored packets that borrows the SDK's storage instead of copying it.
+         * The packets are ordered oldest first. Since the storage is a ring, the packets can be split into two arrays:
+         * packets continues with wrapped_packets.
+         *
+         * New data keeps being stored while the view exists and may overwrite the viewed packets. After reading
+         * from the view, call IsDataViewValid. If it returns false, the data read may be inconsistent.
+         * Every member count stays within the arrays it is read with, even for a packet overwritten while being read.
+         * For that, a packet with more members than its device descriptor announces only shows the announced number;
+         * copy it with GetDataSinceIndex to get all of them.
+         * Destroy the view with DestroyDataView when done.
+         */
+        typedef struct DataView
+        {
+            DataResponseState state;
+            const DevicePacket* packets;
+            uint32_t packet_count;
+            const DevicePacket* wrapped_packets;
+            uint32_t wrapped_packet_count;
+            // Internal. Keeps the storage alive while the view exists.
+            void* guard;
+        } DataView;
+
+        /*
+         * Read position of one consumer of the data stored for a device, used with ReadNewData.
+         *
+         * Every consumer keeps its own cursor, so any number of them can read the same device independently.
+         * A zero initialized cursor starts at the oldest stored packet, GetDataCursor returns one that starts
+         * at the next packet received. Positions count all packets received for the device and do not wrap.
+         */
+        typedef struct DataCursor
+        {
+            // Position of the next packet to read
+            uint64_t next_position;
+            // Packets overwritten before they could be read by the last ReadNewData
+            uint64_t lost_packet_count;
+            // Packets overwritten before they could be read since the cursor was created
+            uint64_t total_lost_packet_count;
+        } DataCursor;
+
+        /*
+         * Contiguous values of one history column. The history is a ring, so the values can be split into two
+         * arrays: data continues with wrapped_data.
+         */
+        typedef struct ColumnSpanf
+        {
+            const float* data;
+            uint32_t count;
+            const float* wrapped_data;
+            uint32_t wrapped_count;
+        } ColumnSpanf;
+
+        typedef struct ColumnSpani
+        {
+            const int32_t* data;
+            uint32_t count;
+            const int32_t* wrapped_data;
+            uint32_t wrapped_count;
+        } ColumnSpani;
+
+        typedef struct ColumnSpanu
+        {
+            const uint32_t* data;
+            uint32_t count;
+            const uint32_t* wrapped_data;
+            uint32_t wrapped_count;
+        } ColumnSpanu;
+
+        /*
+         * Read-only columnar view of the history of one sensor unit of a device, oldest first.
+         * All spans cover the same packets. Raw sensor columns are zero unless raw sensor data was requested.
+         *
+         * Like DataView, the view borrows the SDK's storage. Check IsHistoryViewValid after reading from the view
+         * and destroy it with DestroyHistoryView when done.
+         */
+        typedef struct HistoryView
+        {
+            DataResponseState state;
+            ColumnSpanu timestamps;
+            ColumnSpanf position_x;
+            ColumnSpanf position_y;
+            ColumnSpanf position_z;
+            ColumnSpanf quaternion_w;
+            ColumnSpanf quaternion_x;
+            ColumnSpanf quaternion_y;
+            ColumnSpanf quaternion_z;
+            ColumnSpanf indicator_value;
+            ColumnSpanf motion_indicator;
+            ColumnSpanf bad_data_indicator;
+            ColumnSpani accel_x;
+            ColumnSpani accel_y;
+            ColumnSpani accel_z;
+            ColumnSpani gyro_x;
+            ColumnSpani gyro_y;
+            ColumnSpani gyro_z;
+            ColumnSpani mag_x;
+            ColumnSpani mag_y;
+            ColumnSpani mag_z;
+            // Internal. Keeps the storage alive while the view exists.
+            void* guard;
+        } HistoryView;
+
         typedef struct DeviceID
         {
             uint32_t siu_uuid;
@@ -286,6 +405,40 @@ namespace ommo::api
             uint32_t device_count;
         } DeviceIDList;
 
+        /*
+         * Caller owned output buffer for the buffer variants of the get data functions.
+         * Allocate it once, e.g. with CreateDevicePacketBuffer, and reuse it so polling does not allocate.
+         *
+         * packets must hold <packet_capacity> packets and the member arrays of every packet must hold the
+         * member capacities. Members exceeding their capacity are truncated, truncated_packet_count tells how many of
+         * the returned packets were, so the capacities can be grown. packet_count and truncated_packet_count are set
+         * by the SDK.
+         * CreateDevicePacketBuffer takes the arrays from the SDK's pooled allocator, DestroyDevicePacketBuffer releases
+         * them as well as arrays allocated with new[].
+         */
+        typedef struct DevicePacketBuffer
+        {
+            DevicePacket* packets;
+            uint32_t packet_count;
+            uint32_t truncated_packet_count;
+            uint32_t packet_capacity;
+            uint32_t raw_sensor_data_capacity;
+            uint32_t pose_capacity;
+            uint32_t button_capacity;
+            uint32_t latency_timestamp_capacity;
+        } DevicePacketBuffer;
+
+        /*
+         * Caller owned output buffer for GetAvailableDeviceList.
+         * devices must hold <device_capacity> ids. device_count is set by the SDK.
+         */
+        typedef struct DeviceIDBuffer
+        {
+            DeviceID* devices;
+            uint32_t device_count;
+            uint32_t device_capacity;
+        } DeviceIDBuffer;
+
         typedef enum DataStreamType
         {
             kDeviceData,
@@ -294,6 +447,8 @@ namespace ommo::api
 
         typedef struct DataRequest
         {
+            // Fields to receive, see DataFieldMask. Buttons and battery state outside the mask are neither converted
+            // nor stored, and neither is raw sensor data without include_raw_sensor_data.
             uint32_t data_field_mask;
             uint32_t report_interval;
             uint32_t buffer_depth;
@@ -369,6 +524,17 @@ namespace ommo::api
             uint32_t packet_count;
         } BaseStationDataResponse;
 
+        /*
+         * Caller owned output buffer for the buffer variants of the get base station data functions.
+         * packets must hold <packet_capacity> packets. packet_count is set by the SDK.
+         */
+        typedef struct BaseStationPacketBuffer
+        {
+            BaseStationPacket* packets;
+            uint32_t packet_count;
+            uint32_t packet_capacity;
+        } BaseStationPacketBuffer;
+
         typedef enum WirelessManagementRequestType
         {
             kWirelessManagementRequestNone = 0,
@@ -469,10 +635,21 @@ namespace ommo::api
 
         OMMO_SDK_API DataRequest* CreateDefaultDataRequest();
 
+        /*
+         * Allocate a DevicePacketBuffer holding <packet_capacity> packets, including the member arrays of every packet.
+         * Destroy it with DestroyDevicePacketBuffer.
+         */
+        OMMO_SDK_API DevicePacketBuffer* CreateDevicePacketBuffer(uint32_t packet_capacity, uint32_t raw_sensor_data_capacity, uint32_t pose_capacity, uint32_t button_capacity, uint32_t latency_timestamp_capacity);
+
         /*
          * Copy functions will allocate new memory and perform a deep copy
          * The returned pointer needs to be deleted when done
-         * Allocation uses new and new[] to match the destruction functions.
+         * Allocation uses new and new[] to match the destruction functions. The member arrays of device descriptors,
+         * packets and device data share one block from the SDK's pooled allocator instead. Release them only with the
+         * destruction functions below, never with delete[].
+         *
+         * The destruction functions tell pooled arrays apart from arrays allocated with new[], so structs filled by the
+         * application with new[] arrays can still be released with them.
          */
         OMMO_SDK_API DeviceDescriptor* CopyDeviceDescriptor(const DeviceDescriptor& source);
         OMMO_SDK_API DevicePacket* CopyDevicePacket(const DevicePacket& source);
@@ -490,9 +667,10 @@ namespace ommo::api
          *
          * Functions that handle deletion of dynamically allocated members internal to the structs
          * These functions have 3 purposes
-         * 1. Allow clean up of statically allocated objects that contain dynamic members allocated with 'new' or 'new[]'
+         * 1. Allow clean up of statically allocated objects that contain dynamic members allocated by the library or with 'new[]'
          * 2. Keep internal member deletion logic of each struct in one place
-         * 3. Allow nested structs to call these destruction functions to delete internal states
+         * 3. Allow nested structs to call these destruction functions to delete internal states. Every struct owns the
+         *    members it points to, so this also holds for the elements of arrays such as DataFrame::device_data.
          *
          * NOTE: These functions should NOT be used unless you are managing statically allocated structs with internal dynamic allocation.
          * WARNING: These functions expect a reference which cannot be null. If used with C interop, ensure pointers are not NULL.
@@ -509,7 +687,8 @@ namespace ommo::api
         OMMO_SDK_API void DestroyWirelessManagementEventMembers(WirelessManagementEvent& event);
 
         /*
-         * All destruction functions below assume that standard allocators new and new[] were used.
+         * All destruction functions below assume that the objects were allocated with new, and their members by the library
+         * or with new[].
          * The objects should be ones created and returned by the library to ensure proper allocation and deletion
          *
          * The pointers types do not support static allocation or other allocators.
@@ -526,6 +705,9 @@ namespace ommo::api
         OMMO_SDK_API void DestroyDataFrame(DataFrame* data_frame);
         OMMO_SDK_API void DestroyDevicePacket(DevicePacket* packet);
         OMMO_SDK_API void DestroyDataResponse(DataResponse* response);
+        OMMO_SDK_API void DestroyDataView(DataView* view);
+        OMMO_SDK_API void DestroyDevicePacketBuffer(DevicePacketBuffer* buffer);
+        OMMO_SDK_API void DestroyHistoryView(HistoryView* view);
         OMMO_SDK_API void DestroyBaseStationDataResponse(BaseStationDataResponse* response);
         OMMO_SDK_API void DestroyDeviceIDList(DeviceIDList* list);
         OMMO_SDK_API void DestroyDataRequest(DataRequest* request);
@@ -567,6 +749,9 @@ namespace ommo::api
     using DataFrameUPtr = std::unique_ptr<DataFrame, deleter_fn<DestroyDataFrame>>;
     using DevicePacketUPtr = std::unique_ptr<DevicePacket, deleter_fn<DestroyDevicePacket>>;
     using DataResponseUPtr = std::unique_ptr<DataResponse, deleter_fn<DestroyDataResponse>>;
+    using DataViewUPtr = std::unique_ptr<DataView, deleter_fn<DestroyDataView>>;
+    using DevicePacketBufferUPtr = std::unique_ptr<DevicePacketBuffer, deleter_fn<DestroyDevicePacketBuffer>>;
+    using HistoryViewUPtr = std::unique_ptr<HistoryView, deleter_fn<DestroyHistoryView>>;
     using BaseStationPacketUPtr = std::unique_ptr<BaseStationPacket>;
     using BaseStationDataResponseUPtr = std::unique_ptr<BaseStationDataResponse, deleter_fn<DestroyBaseStationDataResponse>>;
     using DeviceIDListUPtr = std::unique_ptr<DeviceIDList, deleter_fn<DestroyDeviceIDList>>;
@@ -574,6 +759,10 @@ namespace ommo::api
     using TrackingGroupUPtr = std::unique_ptr<TrackingGroup, deleter_fn<DestroyTrackingGroup>>;
     using TrackingGroupEventUPtr = std::unique_ptr<TrackingGroupEvent, deleter_fn<DestroyTrackingGroupEvent>>;
     using WirelessManagementEventUPtr = std::unique_ptr<WirelessManagementEvent, deleter_fn<DestroyWirelessManagementEvent>>;
+
+    // Immutable packets shared by everything that receives them, so a packet is only converted once
+    using TrackingDeviceDataSPtr = std::shared_ptr<const TrackingDeviceData>;
+    using DataFrameSPtr = std::shared_ptr<const DataFrame>;
     
 
     template <typename T, typename D>
@@ -29,6 +29,11 @@
 
 namespace ommo::api
 {
+    /*
+     * Device key of a tracking device: siu_uuid in the upper 32 bits and port_id in the lower 32 bits.
+     * The key is unique for every siu_uuid and port_id pair. Earlier versions shifted siu_uuid by 8 bits only, see
+     * CHANGELOG.md.
+     */
     OMMO_SDK_API uint64_t Hash(const DeviceDescriptor& r);
 
     OMMO_SDK_API uint64_t Hash(const TrackingDeviceData& r);
@@ -58,4 +63,18 @@ namespace ommo::api
      */
     OMMO_SDK_API bool SystemTimeToString(uint64_t milliseconds, char* buffer, size_t buffer_size);
 
+    /*
+     * Check that none of the packets of a DataView has been overwritten by new data since the view was created.
+     *
+     * Call after reading from the view. If false is returned, data read from the view may be inconsistent and
+     * should be discarded.
+     */
+    OMMO_SDK_API bool IsDataViewValid(const DataView& view);
+
+    /*
+     * Check that none of the packets in the history view have been overwritten since the view was created.
+     * Same as IsDataViewValid.
+     */
+    OMMO_SDK_API bool IsHistoryViewValid(const HistoryView& view);
+
 }  // namespace ommo::api
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "device_data_storage.h"
+#include "ommo_service_api.pb.h"
+#include "rpcClientCallData.h"
+#include "sdk_types.h"
+
+namespace ommo
+{
+    class DataManager;
+
+    // Parameters that identify an upstream tracking device data stream
+    struct DeviceDataStreamKey
+    {
+        uint32_t siu_uuid;
+        uint32_t port_id;
+        uint32_t field_mask;
+        api::DeviceFusionMode fusion_mode;
+        bool include_raw_sensor_data;
+        uint32_t report_interval;
+        uint32_t buffer_depth;
+
+        bool operator==(const DeviceDataStreamKey& other) const;
+    };
+
+    struct DeviceDataStreamKeyHash
+    {
+        size_t operator()(const DeviceDataStreamKey& key) const;
+    };
+
+    /*
+     * Upstream tracking device data stream shared by every DataManager that requests the same device with the same
+     * stream parameters. Each received packet is fanned out to all subscribed DataManagers.
+     *
+     * The subscribers own the stream. Once the last subscriber is removed the call is cancelled, and a cancelled
+     * stream does not accept new subscribers.
+     */
+    class SharedDeviceDataStream : public CallDataAssociation
+    {
+    public:
+        explicit SharedDeviceDataStream(const DeviceDataStreamKey& key);
+
+        const DeviceDataStreamKey& GetKey() const;
+
+        // Store the call data delivering the packets of this stream
+        void SetCallData(rpcClientCallData* call_data);
+
+        // Subscribe a DataManager. The storage slot of the device is resolved once here, so publishing a packet does
+        // not look up the storage. Returns false if the stream was already cancelled or has ended.
+        bool AddSubscriber(const std::shared_ptr<DataManager>& data_manager);
+
+        // Unsubscribe a DataManager. Cancels the call if it was the last subscriber.
+        void RemoveSubscriber(const DataManager* data_manager);
+
+        // Pass a received packet to all subscribers. Called from the completion queue thread of the stream.
+        // With several subscribers the packet is converted once and shared by all of them.
+        void Publish(const ommo::TrackingDeviceData& packet);
+        // Pass a packet received as encoded protobuf bytes to all subscribers. With several subscribers the packet is
+        // decoded once and shared by all of them.
+        void Publish(const uint8_t* data, size_t size);
+
+        virtual bool ClearAssociation(void* call_data_ptr) override;
+
+    private:
+        struct Subscriber
+        {
+            std::shared_ptr<DataManager> data_manager;
+            std::shared_ptr<DeviceStorageSlot> slot;
+        };
+        using SubscriberList = std::vector<Subscriber>;
+
+        const DeviceDataStreamKey key_;
+
+        // Protects call_data_, ended_ and replacing the subscriber list
+        std::mutex mutex_;
+        rpcClientCallData* call_data_ = nullptr;
+        bool ended_ = false;
+
+        // Replaced as a whole on change so Publish can iterate a snapshot without taking mutex_
+        std::shared_ptr<const SubscriberList> subscribers_;
+    };
+}  // namespace ommo
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Size class pools for the member arrays of the ommo::api structs.
+ *
+ * Blocks are carved from large slabs and cached on thread-local free lists per size class, so building and destroying
+ * packets does not go through malloc in steady state. Blocks freed on another thread than the one that allocated them
+ * join the free lists of the freeing thread. Free lists that grow too long hand blocks back to a shared list per size
+ * class. Slab memory is kept for reuse and never returned to the system. Requests larger than the biggest size class
+ * go straight to the heap.
+ *
+ * The pool keeps track of the memory it owns, so pointers that did not come from it are recognized without reading
+ * them. SlabPoolFree leaves those alone, and the Delete* functions free them with delete[]. This keeps api structs
+ * that the application filled with new[] arrays working with the Destroy* functions.
+ */
+namespace ommo
+{
+    // Allocate <size> bytes aligned like operator new. Throws std::bad_alloc like operator new.
+    void* SlabPoolAllocate(size_t size);
+
+    // Usable size of memory allocated with SlabPoolAllocate, 0 for nullptr or memory that did not come from the pool
+    size_t SlabPoolBlockSize(const void* memory);
+
+    // Return memory allocated with SlabPoolAllocate. Returns false and leaves the memory alone if it did not come from
+    // the pool. nullptr is ignored.
+    bool SlabPoolFree(void* memory);
+
+    // Allocate an array of <count> elements from the pools. The elements are uninitialized like with new T[count].
+    // Returns nullptr for an empty array.
+    template <typename T>
+    T* NewPooledArray(size_t count)
+    {
+        static_assert(std::is_trivial<T>::value, "Pooled arrays hold plain api structs only");
+        return count == 0 ? nullptr : static_cast<T*>(SlabPoolAllocate(sizeof(T) * count));
+    }
+
+    // Same as NewPooledArray with zeroed elements, like new T[count]()
+    template <typename T>
+    T* NewZeroedPooledArray(size_t count)
+    {
+        T* array = NewPooledArray<T>(count);
+        if (array != nullptr)
+        {
+            std::memset(array, 0, sizeof(T) * count);
+        }
+        return array;
+    }
+
+    // Free an array allocated with NewPooledArray or NewZeroedPooledArray, or with new T[count]
+    template <typename T>
+    void DeletePooledArray(T* array)
+    {
+        if (!SlabPoolFree(array))
+        {
+            delete[] array;
+        }
+    }
+
+    /*
+     * Several arrays sharing one pooled block, so a struct and everything it points to is a single allocation.
+     * Reserve every array, Allocate, then Place the arrays in the same order. Empty arrays are nullptr and take no
+     * space, so the block starts at the first non-empty array. Free it with DeletePooledArrayBlock.
+     */
+    class PooledArrayBlock
+    {
+    public:
+        template <typename T>
+        void Reserve(size_t count)
+        {
+            static_assert(std::is_trivial<T>::value, "Pooled arrays hold plain api structs only");
+            if (count > 0)
+            {
+                size_ = AlignOffset<T>(size_) + sizeof(T) * count;
+            }
+        }
+
+        void Allocate()
+        {
+            data_ = size_ == 0 ? nullptr : static_cast<char*>(SlabPoolAllocate(size_));
+            offset_ = 0;
+        }
+
+        // Place the next reserved array. The elements are uninitialized.
+        template <typename T>
+        T* Place(size_t count)
+        {
+            if (count == 0)
+            {
+                return nullptr;
+            }
+            offset_ = AlignOffset<T>(offset_);
+            T* array = reinterpret_cast<T*>(data_ + offset_);
+            offset_ += sizeof(T) * count;
+            return array;
+        }
+
+    private:
+        template <typename T>
+        static size_t AlignOffset(size_t offset)
+        {
+            static_assert(alignof(T) <= alignof(std::max_align_t), "Pooled blocks are aligned like operator new");
+            return (offset + alignof(T) - 1) & ~(alignof(T) - 1);
+        }
+
+        size_t size_ = 0;
+        size_t offset_ = 0;
+        char* data_ = nullptr;
+    };
+
+    // Free a block of arrays placed by a PooledArrayBlock. Takes all arrays of the block in placement order, the first
+    // non-empty one owns the block. Arrays that do not lie in the block were allocated with new T[count] and are freed
+    // with delete[]. Sets the arrays to nullptr.
+    template <typename... T>
+    void DeletePooledArrayBlock(T*&... arrays)
+    {
+        const char* block = nullptr;
+        ((block = block != nullptr ? block : reinterpret_cast<const char*>(arrays)), ...);
+        const size_t block_size = SlabPoolBlockSize(block);
+        const auto in_block = [block, block_size](const void* array)
+        {
+            const auto address = reinterpret_cast<uintptr_t>(array);
+            const auto start = reinterpret_cast<uintptr_t>(block);
+            return block_size > 0 && address >= start && address < start + block_size;
+        };
+        const auto delete_array = [&in_block](auto*& array)
+        {
+            if (array != nullptr && !in_block(array))
+            {
+                delete[] array;
+            }
+            array = nullptr;
+        };
+        (delete_array(arrays), ...);
+        SlabPoolFree(const_cast<char*>(block));
+    }
+}  // namespace ommo
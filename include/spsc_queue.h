@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ommo
+{
+    /*
+     * Bounded lock-free single-producer single-consumer queue.
+     *
+     * TryPush may only be called from one producer thread and TryPop from one consumer thread at a time.
+     * The capacity is rounded up to the next power of two.
+     */
+    template <typename T>
+    class SpscQueue
+    {
+    public:
+        explicit SpscQueue(size_t capacity)
+        {
+            capacity_ = 1;
+            while (capacity_ < capacity)
+            {
+                capacity_ <<= 1;
+            }
+            mask_ = capacity_ - 1;
+            buffer_ = std::make_unique<T[]>(capacity_);
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // Add an item to the queue. Returns false without taking the item if the queue is full.
+        bool TryPush(T&& item)
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == capacity_)
+            {
+                return false;
+            }
+            buffer_[tail & mask_] = std::move(item);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Remove the oldest item from the queue. Returns false if the queue is empty.
+        bool TryPop(T& item)
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = std::move(buffer_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Number of queued items. The value is only a snapshot when called concurrently with push or pop.
+        size_t Size() const
+        {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+
+        bool Empty() const
+        {
+            return Size() == 0;
+        }
+
+        size_t Capacity() const
+        {
+            return capacity_;
+        }
+
+    private:
+        size_t capacity_;
+        size_t mask_;
+        std::unique_ptr<T[]> buffer_;
+
+        // Keep the producer and consumer indices on separate cache lines to avoid false sharing
+        alignas(64) std::atomic<size_t> head_{ 0 };
+        alignas(64) std::atomic<size_t> tail_{ 0 };
+    };
+}  // namespace ommo
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+ */
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+#include "rpcClientCallData.h"
+
+namespace ommo
+{
+    /*
+     * Tracks the asynchronous unary calls of a ClientManager so Shutdown can cancel them. Unary calls without a
+     * deadline would otherwise keep the completion queues from draining while the service does not answer.
+     * Call data registered here is removed again through ClearAssociation when it is deleted.
+     */
+    class UnaryCallRegistry : public CallDataAssociation
+    {
+    public:
+        // Run start_call, which creates and starts the call data, and register it. Returns false without running
+        // start_call once the registry is stopped.
+        bool StartCall(const std::function<rpcClientCallData*()>& start_call);
+
+        // Reject new calls and cancel the running ones. Their handlers still run with a CANCELLED status.
+        void Stop();
+
+        bool ClearAssociation(void* call_data_ptr) override;
+
+    private:
+        std::mutex mutex_;
+        std::unordered_set<rpcClientCallData*> calls_;
+        bool stopped_ = false;
+    };
+}  // namespace ommo
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "device_data_parts.h"
+#include "sdk_types.h"
+
+/*
+ * Decoder for the protobuf wire format of the streamed tracking device messages. It reads ommo::TrackingDeviceData
+ * and ommo::DataFrame straight from the received bytes into api::TrackingDeviceData, so the data path does not
+ * build an intermediate protobuf message. Unknown fields are skipped like protobuf does.
+ */
+namespace ommo
+{
+    // Minimal reader for the protobuf wire format
+    class WireReader
+    {
+    public:
+        enum WireType : uint32_t
+        {
+            kVarint = 0,
+            kFixed64 = 1,
+            kLengthDelimited = 2,
+            kFixed32 = 5
+        };
+
+        WireReader(const uint8_t* data, size_t size) : pos_(data), end_(data + size) {}
+
+        bool AtEnd() const { return pos_ == end_; }
+
+        // Read the next field tag. Returns false at the end of the data or on a malformed tag.
+        bool ReadTag(uint32_t& field_number, uint32_t& wire_type)
+        {
+            uint64_t tag;
+            if (AtEnd() || !ReadVarint(tag))
+            {
+                return false;
+            }
+            field_number = static_cast<uint32_t>(tag >> 3);
+            wire_type = static_cast<uint32_t>(tag & 7);
+            return field_number != 0;
+        }
+
+        bool ReadVarint(uint64_t& value)
+        {
+            value = 0;
+            for (uint32_t shift = 0; shift < 64 && pos_ < end_; shift += 7)
+            {
+                const uint8_t byte = *pos_++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool ReadFixed32(uint32_t& value)
+        {
+            if (end_ - pos_ < 4)
+            {
+                return false;
+            }
+            value = static_cast<uint32_t>(pos_[0]) | static_cast<uint32_t>(pos_[1]) << 8 |
+                static_cast<uint32_t>(pos_[2]) << 16 | static_cast<uint32_t>(pos_[3]) << 24;
+            pos_ += 4;
+            return true;
+        }
+
+        bool ReadFloat(float& value)
+        {
+            uint32_t bits;
+            if (!ReadFixed32(bits))
+            {
+                return false;
+            }
+            static_assert(sizeof(float) == sizeof(uint32_t), "float must be 32 bit");
+            std::memcpy(&value, &bits, sizeof(value));
+            return true;
+        }
+
+        // Read a length-delimited field into a reader over its bytes
+        bool ReadLengthDelimited(WireReader& field)
+        {
+            uint64_t length;
+            if (!ReadVarint(length) || length > static_cast<uint64_t>(end_ - pos_))
+            {
+                return false;
+            }
+            field = WireReader(pos_, static_cast<size_t>(length));
+            pos_ += length;
+            return true;
+        }
+
+        // Skip the value of a field with the given wire type
+        bool Skip(uint32_t wire_type)
+        {
+            uint64_t value;
+            WireReader field(nullptr, 0);
+            switch (wire_type)
+            {
+            case kVarint:
+                return ReadVarint(value);
+            case kFixed64:
+                return Advance(8);
+            case kLengthDelimited:
+                return ReadLengthDelimited(field);
+            case kFixed32:
+                return Advance(4);
+            default:
+                // Groups are not used by the service API
+                return false;
+            }
+        }
+
+        const uint8_t* Data() const { return pos_; }
+        size_t Size() const { return static_cast<size_t>(end_ - pos_); }
+
+    private:
+        bool Advance(size_t count)
+        {
+            if (static_cast<size_t>(end_ - pos_) < count)
+            {
+                return false;
+            }
+            pos_ += count;
+            return true;
+        }
+
+        const uint8_t* pos_;
+        const uint8_t* end_;
+    };
+
+    // Device and member array sizes of an encoded TrackingDeviceData
+    struct EncodedDeviceDataLayout
+    {
+        uint32_t siu_uuid = 0;
+        uint32_t port_id = 0;
+        uint32_t raw_sensor_data_count = 0;
+        // Number of positions. Quaternions and indicator values beyond this count are ignored like the converters do.
+        uint32_t pose_count = 0;
+        uint32_t button_count = 0;
+        uint32_t latency_timestamp_count = 0;
+
+        // Index times of the packet: the device timestamp and the latest steady time of the sample latency
+        // timestamps, or 0 if the packet has none
+        uint32_t timestamp = 0;
+        uint64_t sample_time = 0;
+
+        // DeviceDataPart flags to decode. The counts of the other parts are 0 and their fields are skipped.
+        uint32_t parts = kAllDeviceDataParts;
+    };
+
+    // Read the device, the member array sizes and the index times of an encoded TrackingDeviceData, counting only the
+    // DeviceDataPart flags in <parts>. Returns false if the data is malformed.
+    bool ScanEncodedDeviceData(const uint8_t* data, size_t size, EncodedDeviceDataLayout& layout, uint32_t parts = kAllDeviceDataParts);
+
+    // Decode an encoded TrackingDeviceData scanned into <layout>. The member arrays of <device_data> must hold the
+    // counts of <layout>. Returns false if the data is malformed, in which case <device_data> is incomplete.
+    bool DecodeEncodedDeviceData(const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout, api::TrackingDeviceData& device_data);
+
+    // Decode an encoded TrackingDeviceData into a packet that owns its member arrays, decoding only the DeviceDataPart
+    // flags in <parts>. Returns nullptr if the data is malformed.
+    api::TrackingDeviceDataSPtr DecodeSharedTrackingDeviceData(const uint8_t* data, size_t size, uint32_t parts = kAllDeviceDataParts);
+
+    // Call <visit> with the bytes of every TrackingDeviceData of an encoded DataFrame. Returns false if the data is malformed.
+    template <typename Visitor>
+    bool ForEachEncodedDataFrameDevice(const uint8_t* data, size_t size, Visitor&& visit)
+    {
+        // DataFrame.device_data
+        constexpr uint32_t device_data_field = 1;
+
+        WireReader reader(data, size);
+        uint32_t field_number;
+        uint32_t wire_type;
+        while (reader.ReadTag(field_number, wire_type))
+        {
+            if (field_number == device_data_field && wire_type == WireReader::kLengthDelimited)
+            {
+                WireReader device_data(nullptr, 0);
+                if (!reader.ReadLengthDelimited(device_data))
+                {
+                    return false;
+                }
+                visit(device_data.Data(), device_data.Size());
+            }
+            else if (!reader.Skip(wire_type))
+            {
+                return false;
+            }
+        }
+        return reader.AtEnd();
+    }
+}  // namespace ommo
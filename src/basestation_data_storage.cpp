@@ -10,6 +10,8 @@
 #include "logger_base.h"
 #include "protobuf_converters.h"
 
+#include <algorithm>
+
 namespace ommo
 {
 
@@ -253,6 +255,78 @@ namespace ommo
         return result;
     }
 
+    const api::BaseStationPacket& BaseStationDataStorage::GetStoredPacket(int32_t position, int32_t read_packet_num) const
+    {
+        if (position < read_packet_num)
+        {
+            return read_buffer_.packet_buffer_ptr[position];
+        }
+        return write_buffer_.packet_buffer_ptr[position - read_packet_num];
+    }
+
+    api::DataResponseState BaseStationDataStorage::GetLatestData(uint32_t request_count, api::BaseStationPacketBuffer& buffer)
+    {
+        buffer.packet_count = 0;
+
+        // The write and read buffers cannot switch while reading data.
+        std::shared_lock<std::shared_mutex> lock(switch_mutex_);
+
+        const int32_t read_packet_num = read_buffer_.data_num;
+        const uint32_t total_count = read_packet_num + write_buffer_.data_num;
+        const uint32_t count = std::min({ request_count, total_count, buffer.packet_capacity });
+        if (count == 0)
+        {
+            return api::DataResponseState::kNoData;
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            buffer.packets[i] = GetStoredPacket(total_count - count + i, read_packet_num);
+        }
+        buffer.packet_count = count;
+        return count == request_count ? api::DataResponseState::kSuccess : api::DataResponseState::kPartialData;
+    }
+
+    api::DataResponseState BaseStationDataStorage::GetDataSinceIndex(uint32_t start_idx, api::BaseStationPacketBuffer& buffer)
+    {
+        buffer.packet_count = 0;
+
+        // The write and read buffers cannot switch while reading data.
+        std::shared_lock<std::shared_mutex> lock(switch_mutex_);
+
+        const int32_t read_packet_num = read_buffer_.data_num;
+        const uint32_t total_count = read_packet_num + write_buffer_.data_num;
+        if (total_count == 0)
+        {
+            return api::DataResponseState::kNoData;
+        }
+
+        const uint32_t earliest_idx = GetStoredPacket(0, read_packet_num).packet_idx;
+        const uint32_t latest_idx = GetStoredPacket(total_count - 1, read_packet_num).packet_idx;
+        if (latest_idx < start_idx)
+        {
+            OMMOLOG_WARN("Requested packet is not available yet. request_idx={} latest_idx={}", start_idx, latest_idx);
+            return api::DataResponseState::kNoData;
+        }
+
+        bool complete = earliest_idx <= start_idx;
+        const uint32_t first = complete ? start_idx - earliest_idx : 0;
+        // Keep the oldest packets if the buffer is too small so the caller can continue from the last one
+        const uint32_t count = std::min(total_count - first, buffer.packet_capacity);
+        complete = complete && count == total_count - first;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            buffer.packets[i] = GetStoredPacket(first + i, read_packet_num);
+        }
+        buffer.packet_count = count;
+        if (count == 0)
+        {
+            return api::DataResponseState::kNoData;
+        }
+        return complete ? api::DataResponseState::kSuccess : api::DataResponseState::kPartialData;
+    }
+
     void BaseStationDataStorage::SetDataStream(rpcClientCallData* call_data)
     {
         std::unique_lock<std::mutex> lock(base_station_stream_mtx_);
@@ -8,6 +8,7 @@
 #include "client_context.h"
 #include "client_context_impl.h"
 
+#include <algorithm>
 #include <string>
 #include <memory>
 #include <unordered_map>
@@ -16,7 +17,10 @@
 
 namespace ommo::api
 {
-    ClientContext::ClientContext(const char* server_address) : p_impl_(new ClientContext::impl(server_address)) {}
+    ClientContext::ClientContext(const char* server_address) : p_impl_(new ClientContext::impl(server_address, 1)) {}
+
+    ClientContext::ClientContext(const char* server_address, uint32_t completion_queue_count)
+        : p_impl_(new ClientContext::impl(server_address, completion_queue_count)) {}
 
     ClientContext::~ClientContext()
     {
@@ -81,6 +85,26 @@ namespace ommo::api
         p_impl_->ResetChannelStateCallback();
     }
 
+    void ClientContext::SetDeviceEventBatchWindow(uint32_t milliseconds)
+    {
+        p_impl_->SetDeviceEventBatchWindow(milliseconds);
+    }
+
+    void ClientContext::SetWireDecoding(bool enabled)
+    {
+        p_impl_->SetWireDecoding(enabled);
+    }
+
+    void ClientContext::SetColumnarHistory(bool enabled)
+    {
+        p_impl_->SetColumnarHistory(enabled);
+    }
+
+    void ClientContext::SetConvertOnRead(bool enabled)
+    {
+        p_impl_->SetConvertOnRead(enabled);
+    }
+
     uint32_t ClientContext::RequestDeviceData(api::DataRequest& request)
     {
         return p_impl_->RequestDeviceData(request);
@@ -115,6 +139,16 @@ namespace ommo::api
         return p_impl_->GetBaseStationDataSinceIndex(request_tag, start_index);
     }
 
+    api::DataResponseState ClientContext::GetLatestBaseStationData(uint32_t request_tag, int32_t num_packets, api::BaseStationPacketBuffer& buffer)
+    {
+        return p_impl_->GetLatestBaseStationData(request_tag, num_packets, buffer);
+    }
+
+    api::DataResponseState ClientContext::GetBaseStationDataSinceIndex(uint32_t request_tag, int32_t start_index, api::BaseStationPacketBuffer& buffer)
+    {
+        return p_impl_->GetBaseStationDataSinceIndex(request_tag, start_index, buffer);
+    }
+
     void ClientContext::CloseRequest(uint32_t request_tag)
     {
         p_impl_->CloseRequest(request_tag);
@@ -125,6 +159,11 @@ namespace ommo::api
         return p_impl_->GetAvailableDeviceList(request_tag);
     }
 
+    uint32_t ClientContext::GetAvailableDeviceList(uint32_t request_tag, api::DeviceIDBuffer& buffer)
+    {
+        return p_impl_->GetAvailableDeviceList(request_tag, buffer);
+    }
+
     api::DataResponse* ClientContext::GetLatestData(uint32_t request_tag, const api::DeviceID& device_id)
     {
         return p_impl_->GetLatestData(request_tag, device_id);
@@ -140,6 +179,51 @@ namespace ommo::api
         return p_impl_->GetDataSinceIndex(request_tag, device_id, start_index);
     }
 
+    api::DataView* ClientContext::GetLatestDataView(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets)
+    {
+        return p_impl_->GetLatestDataView(request_tag, device_id, num_packets);
+    }
+
+    api::DataResponse* ClientContext::GetDataInTimeRange(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t start_time, uint64_t end_time)
+    {
+        return p_impl_->GetDataInTimeRange(request_tag, device_id, time_base, start_time, end_time);
+    }
+
+    api::DataResponse* ClientContext::GetNearestSample(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t time)
+    {
+        return p_impl_->GetNearestSample(request_tag, device_id, time_base, time);
+    }
+
+    api::HistoryView* ClientContext::GetHistoryView(uint32_t request_tag, const api::DeviceID& device_id, uint32_t sensor_unit_index, int32_t num_packets)
+    {
+        return p_impl_->GetHistoryView(request_tag, device_id, sensor_unit_index, num_packets);
+    }
+
+    api::DataCursor ClientContext::GetDataCursor(uint32_t request_tag, const api::DeviceID& device_id)
+    {
+        return p_impl_->GetDataCursor(request_tag, device_id);
+    }
+
+    api::DataResponse* ClientContext::ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor)
+    {
+        return p_impl_->ReadNewData(request_tag, device_id, cursor);
+    }
+
+    api::DataResponseState ClientContext::ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor, api::DevicePacketBuffer& buffer)
+    {
+        return p_impl_->ReadNewData(request_tag, device_id, cursor, buffer);
+    }
+
+    api::DataResponseState ClientContext::GetLatestData(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets, api::DevicePacketBuffer& buffer)
+    {
+        return p_impl_->GetLatestData(request_tag, device_id, num_packets, buffer);
+    }
+
+    api::DataResponseState ClientContext::GetDataSinceIndex(uint32_t request_tag, const api::DeviceID& device_id, int32_t start_index, api::DevicePacketBuffer& buffer)
+    {
+        return p_impl_->GetDataSinceIndex(request_tag, device_id, start_index, buffer);
+    }
+
     void ClientContext::RegisterTrackingDeviceDataCallback(uint32_t request_tag, std::function<void(const api::TrackingDeviceData&)> callback_function)
     {
         p_impl_->RegisterTrackingDeviceDataCallback(request_tag, callback_function);
@@ -160,6 +244,21 @@ namespace ommo::api
         p_impl_->ResetDataFrameCallback(request_tag);
     }
 
+    void ClientContext::SetCallbackDispatchMode(uint32_t request_tag, bool enabled, uint32_t queue_capacity)
+    {
+        p_impl_->SetCallbackDispatchMode(request_tag, enabled, queue_capacity);
+    }
+
+    size_t ClientContext::GetCallbackQueueDepth(uint32_t request_tag)
+    {
+        return p_impl_->GetCallbackQueueDepth(request_tag);
+    }
+
+    uint64_t ClientContext::GetDroppedCallbackCount(uint32_t request_tag)
+    {
+        return p_impl_->GetDroppedCallbackCount(request_tag);
+    }
+
     api::WirelessManager* ClientContext::CreateWirelessManager()
     {
         return p_impl_->CreateWirelessManager();
@@ -187,14 +286,46 @@ namespace ommo::api
         return p_impl_->SelectReferenceDevice(enabled, siu_uuid, port_num);
     }
 
-    ClientContext::impl::impl(const char* server_address)
+    void ClientContext::GetTrackingDevicesAsync(std::function<void(api::TrackingDevices*)> callback, uint32_t timeout_ms)
+    {
+        p_impl_->GetTrackingDevicesAsync(callback, timeout_ms);
+    }
+
+    void ClientContext::GetHardwareStatesAsync(std::function<void(api::HardwareStates*)> callback, uint32_t timeout_ms)
+    {
+        p_impl_->GetHardwareStatesAsync(callback, timeout_ms);
+    }
+
+    void ClientContext::SetBaseStationMotorRunningAsync(bool active, std::function<void(bool)> callback, uint32_t timeout_ms)
+    {
+        p_impl_->SetBaseStationMotorRunningAsync(active, callback, timeout_ms);
+    }
+
+    void ClientContext::EnableDataLoggingAsync(const char* directory, const char* file_name, bool overwrite, std::function<void(api::DataLogState)> callback, uint32_t timeout_ms)
+    {
+        std::string directory_str = std::string(directory);
+        std::string file_name_str = std::string(file_name);
+        p_impl_->EnableDataLoggingAsync(directory_str, file_name_str, overwrite, callback, timeout_ms);
+    }
+
+    void ClientContext::DisableDataLoggingAsync(std::function<void(api::DataLogState)> callback, uint32_t timeout_ms)
+    {
+        p_impl_->DisableDataLoggingAsync(callback, timeout_ms);
+    }
+
+    void ClientContext::SelectReferenceDeviceAsync(bool enabled, uint32_t siu_uuid, uint32_t port_num, std::function<void(bool)> callback, uint32_t timeout_ms)
+    {
+        p_impl_->SelectReferenceDeviceAsync(enabled, siu_uuid, port_num, callback, timeout_ms);
+    }
+
+    ClientContext::impl::impl(const char* server_address, uint32_t completion_queue_count)
     {
         std::string address = "localhost:50051";
         if (server_address != nullptr && server_address[0] != '\0')
         {
             address = std::string(server_address);
         }
-        client_manager_ = std::make_unique<ommo::ClientManager>(address);
+        client_manager_ = std::make_unique<ommo::ClientManager>(address, completion_queue_count);
     }
 
     void ClientContext::impl::Start()
@@ -242,6 +373,26 @@ namespace ommo::api
         client_manager_->ResetChannelStateCallback();
     }
 
+    void ClientContext::impl::SetDeviceEventBatchWindow(uint32_t milliseconds)
+    {
+        client_manager_->SetDeviceEventBatchWindow(milliseconds);
+    }
+
+    void ClientContext::impl::SetWireDecoding(bool enabled)
+    {
+        client_manager_->SetWireDecoding(enabled);
+    }
+
+    void ClientContext::impl::SetColumnarHistory(bool enabled)
+    {
+        client_manager_->SetColumnarHistory(enabled);
+    }
+
+    void ClientContext::impl::SetConvertOnRead(bool enabled)
+    {
+        client_manager_->SetConvertOnRead(enabled);
+    }
+
     uint32_t ClientContext::impl::RequestDeviceData(api::DataRequest& request)
     {
         std::shared_ptr<ommo::DataManager> manager = client_manager_->RequestDeviceData(request);
@@ -282,6 +433,18 @@ namespace ommo::api
         return new api::DeviceIDList{ nullptr, 0 };
     }
 
+    uint32_t ClientContext::impl::GetAvailableDeviceList(uint32_t request_tag, api::DeviceIDBuffer& buffer)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetDeviceStorageList(buffer);
+        }
+        buffer.device_count = 0;
+        return 0;
+    }
+
             // Get data functions
     api::DataResponse* ClientContext::impl::GetLatestData(uint32_t request_tag, const api::DeviceID& device_id)
     {
@@ -316,6 +479,113 @@ namespace ommo::api
         return new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 };
     }
 
+    api::DataView* ClientContext::impl::GetLatestDataView(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetLatestDataView(device_id, num_packets).release();
+        }
+        return new api::DataView{ api::DataResponseState::kNoData, nullptr, 0, nullptr, 0, nullptr };
+    }
+
+    api::DataResponse* ClientContext::impl::GetDataInTimeRange(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t start_time, uint64_t end_time)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetDataInTimeRange(device_id, time_base, start_time, end_time).release();
+        }
+        return new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 };
+    }
+
+    api::DataResponse* ClientContext::impl::GetNearestSample(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t time)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetNearestSample(device_id, time_base, time).release();
+        }
+        return new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 };
+    }
+
+    api::HistoryView* ClientContext::impl::GetHistoryView(uint32_t request_tag, const api::DeviceID& device_id, uint32_t sensor_unit_index, int32_t num_packets)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetHistoryView(device_id, sensor_unit_index, num_packets).release();
+        }
+        api::HistoryView* view = new api::HistoryView();
+        view->state = api::DataResponseState::kNoData;
+        return view;
+    }
+
+    api::DataCursor ClientContext::impl::GetDataCursor(uint32_t request_tag, const api::DeviceID& device_id)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetDataCursor(device_id);
+        }
+        return api::DataCursor{ 0, 0, 0 };
+    }
+
+    api::DataResponse* ClientContext::impl::ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->ReadNewData(device_id, cursor).release();
+        }
+        return new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 };
+    }
+
+    api::DataResponseState ClientContext::impl::ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor, api::DevicePacketBuffer& buffer)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->ReadNewData(device_id, cursor, buffer);
+        }
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        return api::DataResponseState::kNoData;
+    }
+
+    api::DataResponseState ClientContext::impl::GetLatestData(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets, api::DevicePacketBuffer& buffer)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetLatestData(device_id, num_packets, buffer);
+        }
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        return api::DataResponseState::kNoData;
+    }
+
+    api::DataResponseState ClientContext::impl::GetDataSinceIndex(uint32_t request_tag, const api::DeviceID& device_id, int32_t start_index, api::DevicePacketBuffer& buffer)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetDataSinceIndex(device_id, start_index, buffer);
+        }
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        return api::DataResponseState::kNoData;
+    }
+
     uint32_t ClientContext::impl::RequestBaseStationData()
     {
         /*
@@ -385,6 +655,32 @@ namespace ommo::api
         return base_station_data_storage_->GetDataSinceIndex(start_index).release();
     }
 
+    api::DataResponseState ClientContext::impl::GetLatestBaseStationData(uint32_t request_tag, int32_t num_packets, api::BaseStationPacketBuffer& buffer)
+    {
+        std::unique_lock<std::shared_mutex> lock(base_station_request_list_mutex_);
+        if (nullptr == base_station_data_storage_ || base_station_request_list_.find(request_tag) == base_station_request_list_.end())
+        {
+            buffer.packet_count = 0;
+            return api::DataResponseState::kNoData;
+        }
+        lock.unlock();
+
+        return base_station_data_storage_->GetLatestData(std::max(num_packets, 0), buffer);
+    }
+
+    api::DataResponseState ClientContext::impl::GetBaseStationDataSinceIndex(uint32_t request_tag, int32_t start_index, api::BaseStationPacketBuffer& buffer)
+    {
+        std::unique_lock<std::shared_mutex> lock(base_station_request_list_mutex_);
+        if (nullptr == base_station_data_storage_ || base_station_request_list_.find(request_tag) == base_station_request_list_.end())
+        {
+            buffer.packet_count = 0;
+            return api::DataResponseState::kNoData;
+        }
+        lock.unlock();
+
+        return base_station_data_storage_->GetDataSinceIndex(start_index, buffer);
+    }
+
     void ClientContext::impl::RegisterTrackingDeviceDataCallback(uint32_t request_tag, std::function<void(const api::TrackingDeviceData&)> callback_function)
     {
         std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
@@ -425,6 +721,50 @@ namespace ommo::api
         }
     }
 
+    void ClientContext::impl::SetCallbackDispatchMode(uint32_t request_tag, bool enabled, uint32_t queue_capacity)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item == data_managers_.end())
+        {
+            return;
+        }
+        // Keep the DataManager alive but release the map lock, switching modes waits for the running callback to return
+        std::shared_ptr<ommo::DataManager> data_manager = item->second;
+        lock.unlock();
+
+        if (enabled)
+        {
+            data_manager->EnableCallbackDispatch(queue_capacity);
+        }
+        else
+        {
+            data_manager->DisableCallbackDispatch();
+        }
+    }
+
+    size_t ClientContext::impl::GetCallbackQueueDepth(uint32_t request_tag)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetCallbackQueueDepth();
+        }
+        return 0;
+    }
+
+    uint64_t ClientContext::impl::GetDroppedCallbackCount(uint32_t request_tag)
+    {
+        std::shared_lock<std::shared_mutex> lock(data_manager_map_mutex_);
+        auto item = data_managers_.find(request_tag);
+        if (item != data_managers_.end())
+        {
+            return item->second->GetDroppedCallbackCount();
+        }
+        return 0;
+    }
+
     api::WirelessManager* ClientContext::impl::CreateWirelessManager()
     {
         return client_manager_->CreateWirelessManager().get();
@@ -449,4 +789,52 @@ namespace ommo::api
     {
         return client_manager_->SelectReferenceDevice(enabled, siu_uuid, port_num);
     }
+
+    void ClientContext::impl::GetTrackingDevicesAsync(std::function<void(api::TrackingDevices*)> callback, uint32_t timeout_ms)
+    {
+        client_manager_->GetTrackingDevicesAsync(
+            [callback](api::TrackingDevicesUPtr devices)
+            {
+                if (callback)
+                {
+                    // Ownership is handed over to the user, same as GetTrackingDevices
+                    callback(devices.release());
+                }
+            },
+            timeout_ms);
+    }
+
+    void ClientContext::impl::GetHardwareStatesAsync(std::function<void(api::HardwareStates*)> callback, uint32_t timeout_ms)
+    {
+        client_manager_->GetHardwareStatesAsync(
+            [callback](api::HardwareStatesUPtr states)
+            {
+                if (callback)
+                {
+                    // Ownership is handed over to the user, same as GetHardwareStates
+                    callback(states.release());
+                }
+            },
+            timeout_ms);
+    }
+
+    void ClientContext::impl::SetBaseStationMotorRunningAsync(bool active, std::function<void(bool)> callback, uint32_t timeout_ms)
+    {
+        client_manager_->SetBaseStationMotorRunningAsync(active, callback, timeout_ms);
+    }
+
+    void ClientContext::impl::EnableDataLoggingAsync(std::string directory, std::string file_name, bool overwrite, std::function<void(api::DataLogState)> callback, uint32_t timeout_ms)
+    {
+        client_manager_->EnableDataLoggingAsync(directory, file_name, overwrite, callback, timeout_ms);
+    }
+
+    void ClientContext::impl::DisableDataLoggingAsync(std::function<void(api::DataLogState)> callback, uint32_t timeout_ms)
+    {
+        client_manager_->DisableDataLoggingAsync(callback, timeout_ms);
+    }
+
+    void ClientContext::impl::SelectReferenceDeviceAsync(bool enabled, uint32_t siu_uuid, uint32_t port_num, std::function<void(bool)> callback, uint32_t timeout_ms)
+    {
+        client_manager_->SelectReferenceDeviceAsync(enabled, siu_uuid, port_num, callback, timeout_ms);
+    }
 } // namespace ommo::api
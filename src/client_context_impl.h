@@ -15,7 +15,7 @@ namespace ommo::api
     class ClientContext::impl
     {
         public:
-            explicit impl(const char* server_address);
+            impl(const char* server_address, uint32_t completion_queue_count);
 
             void Start();
 
@@ -35,6 +35,14 @@ namespace ommo::api
 
             void ResetChannelStateCallback();
 
+            void SetDeviceEventBatchWindow(uint32_t milliseconds);
+
+            void SetWireDecoding(bool enabled);
+
+            void SetColumnarHistory(bool enabled);
+
+            void SetConvertOnRead(bool enabled);
+
             uint32_t RequestDeviceData(api::DataRequest& request);
 
             uint32_t RequestDataFrame(api::DataRequest& request);
@@ -42,6 +50,7 @@ namespace ommo::api
             void CloseRequest(uint32_t request_tag);
 
             api::DeviceIDList* GetAvailableDeviceList(uint32_t request_tag);
+            uint32_t GetAvailableDeviceList(uint32_t request_tag, api::DeviceIDBuffer& buffer);
 
             // Get data functions
             api::DataResponse* GetLatestData(uint32_t request_tag, const api::DeviceID& device_id);
@@ -50,6 +59,24 @@ namespace ommo::api
 
             api::DataResponse* GetDataSinceIndex(uint32_t request_tag, const api::DeviceID& device_id, int32_t start_index);
 
+            api::DataView* GetLatestDataView(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets);
+
+            api::DataResponse* GetDataInTimeRange(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t start_time, uint64_t end_time);
+
+            api::DataResponse* GetNearestSample(uint32_t request_tag, const api::DeviceID& device_id, api::TimeBase time_base, uint64_t time);
+
+            api::HistoryView* GetHistoryView(uint32_t request_tag, const api::DeviceID& device_id, uint32_t sensor_unit_index, int32_t num_packets);
+
+            api::DataCursor GetDataCursor(uint32_t request_tag, const api::DeviceID& device_id);
+
+            api::DataResponse* ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor);
+
+            api::DataResponseState ReadNewData(uint32_t request_tag, const api::DeviceID& device_id, api::DataCursor& cursor, api::DevicePacketBuffer& buffer);
+
+            api::DataResponseState GetLatestData(uint32_t request_tag, const api::DeviceID& device_id, int32_t num_packets, api::DevicePacketBuffer& buffer);
+
+            api::DataResponseState GetDataSinceIndex(uint32_t request_tag, const api::DeviceID& device_id, int32_t start_index, api::DevicePacketBuffer& buffer);
+
             uint32_t RequestBaseStationData();
 
             void CloseBaseStationDataRequest(uint32_t request_tag);
@@ -60,6 +87,10 @@ namespace ommo::api
 
             api::BaseStationDataResponse* GetBaseStationDataSinceIndex(uint32_t request_tag, int32_t start_index);
 
+            api::DataResponseState GetLatestBaseStationData(uint32_t request_tag, int32_t num_packets, api::BaseStationPacketBuffer& buffer);
+
+            api::DataResponseState GetBaseStationDataSinceIndex(uint32_t request_tag, int32_t start_index, api::BaseStationPacketBuffer& buffer);
+
             void RegisterTrackingDeviceDataCallback(uint32_t request_tag, std::function<void(const api::TrackingDeviceData&)> callback_function);
 
             void ResetTrackingDeviceDataCallback(uint32_t request_tag);
@@ -68,6 +99,12 @@ namespace ommo::api
 
             void ResetDataFrameCallback(uint32_t request_tag);
 
+            void SetCallbackDispatchMode(uint32_t request_tag, bool enabled, uint32_t queue_capacity);
+
+            size_t GetCallbackQueueDepth(uint32_t request_tag);
+
+            uint64_t GetDroppedCallbackCount(uint32_t request_tag);
+
             api::WirelessManager* CreateWirelessManager();
 
             void DeleteWirelessManager(api::WirelessManager* wireless_manager);
@@ -78,6 +115,18 @@ namespace ommo::api
 
             bool SelectReferenceDevice(bool enabled, uint32_t siu_uuid, uint32_t port_num);
 
+            void GetTrackingDevicesAsync(std::function<void(api::TrackingDevices*)> callback, uint32_t timeout_ms);
+
+            void GetHardwareStatesAsync(std::function<void(api::HardwareStates*)> callback, uint32_t timeout_ms);
+
+            void SetBaseStationMotorRunningAsync(bool active, std::function<void(bool)> callback, uint32_t timeout_ms);
+
+            void EnableDataLoggingAsync(std::string directory, std::string file_name, bool overwrite, std::function<void(api::DataLogState)> callback, uint32_t timeout_ms);
+
+            void DisableDataLoggingAsync(std::function<void(api::DataLogState)> callback, uint32_t timeout_ms);
+
+            void SelectReferenceDeviceAsync(bool enabled, uint32_t siu_uuid, uint32_t port_num, std::function<void(bool)> callback, uint32_t timeout_ms);
+
         private:
             std::unique_ptr<ommo::ClientManager> client_manager_;
 
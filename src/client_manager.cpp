@@ -6,6 +6,8 @@
  * OF ANY KIND, either express or implied.
 */
 
+#include <algorithm>
+#include <chrono>
 #include <iomanip>
 #include <filesystem>
 #include "client_manager.h"
@@ -13,9 +15,11 @@
 #include "rpcOpenTrackingDeviceDataStreamClientCallData.h"
 #include "rpcOpenTrackingDevicesEventStreamClientCallData.h"
 #include "rpcOpenDataFrameStreamClientCallData.h"
+#include "rpc_encoded_stream_client_call_data.h"
 #include "rpc_base_station_data_stream_client_call_data.h"
 #include "rpc_tracking_group_data_stream_client_call_data.h"
 #include "rpc_tracking_groups_event_stream_client_call_data.h"
+#include "rpc_unary_client_call_data.h"
 #include "rpc_wireless_management_stream_client_call_data.h"
 #include "protobuf_converters.h"
 #include "sdk_utils.h"
@@ -25,57 +29,120 @@
 
 namespace
 {
-    // Check the gRPC channel state every <interval> seconds
-    int check_channel_interval = 1;
+    // Deadline of a channel state watch. The monitor is woken by state changes and alarms, the deadline only bounds
+    // how long an unchanged channel goes without being checked again.
+    constexpr std::chrono::minutes channel_watch_timeout{ 10 };
+
+    // Tags used on the channel monitor completion queue
+    void* const channel_state_changed_tag = reinterpret_cast<void*>(1);
+    void* const channel_monitor_wake_tag = reinterpret_cast<void*>(2);
+    void* const device_event_batch_tag = reinterpret_cast<void*>(3);
+
+    // Affinity key used for streams that are not tied to a specific device (events, base station, wireless)
+    constexpr uint64_t control_stream_affinity_key = 0;
+
+    // Spread affinity keys evenly across the completion queues. Device hashes and pointer values are not uniformly
+    // distributed in their low bits, so they are mixed with a Fibonacci hash before taking the modulo.
+    size_t AffinityIndex(uint64_t affinity_key, size_t queue_count)
+    {
+        return static_cast<size_t>((affinity_key * 0x9E3779B97F4A7C15ull) >> 32) % queue_count;
+    }
 }
 
 namespace ommo
 {
 
-    ClientManager::ClientManager(std::string server_address) : server_address_(server_address)
+    ClientManager::ClientManager(std::string server_address, uint32_t completion_queue_count) : server_address_(server_address)
     {
         // Initialize the grpc channel.
         channel_ = grpc::CreateChannel(server_address_, grpc::InsecureChannelCredentials());
+        // Create the stub once. Stubs are thread safe and are shared by all RPCs and streams on this channel.
+        stub_ = ommo::CoreService::NewStub(channel_);
+        generic_stub_ = std::make_shared<grpc::GenericStub>(channel_);
+
+        // Create the completion queues. At least one queue is always required.
+        completion_queue_count = std::max<uint32_t>(completion_queue_count, 1);
+        for (uint32_t i = 0; i < completion_queue_count; i++)
+        {
+            completion_queues_.emplace_back(std::make_unique<CompletionQueue>());
+        }
+
+        // The monitor completion queue lives as long as the channel, since a state watch cannot be cancelled
+        monitor_cq_ = std::make_unique<CompletionQueue>();
     }
 
     ClientManager::~ClientManager()
     {
         Shutdown();
+
+        // Releasing the channel completes the outstanding state watch, so the monitor completion queue can be drained
+        stub_.reset();
+        generic_stub_.reset();
+        channel_.reset();
+        monitor_cq_->Shutdown();
+        void* tag;
+        bool ok;
+        while (monitor_cq_->Next(&tag, &ok))
+        {
+        }
     }
 
     rpcClientCallData* ClientManager::OpenTrackingDeviceDataStream(const ommo::TrackingDeviceDataStreamRequest& request, const std::function<void(const ommo::TrackingDeviceData&)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association)
     {
-        return new rpcOpenTrackingDeviceDataStreamClientCallData(channel_, &completion_queue_, request, listener_function, association);
+        // Pin the stream to a completion queue by device so packets of a device are always processed in order
+        CompletionQueue* cq = GetCompletionQueue(api::Hash(request.siu_uuid(), request.port_id()));
+        return new rpcOpenTrackingDeviceDataStreamClientCallData(stub_, cq, request, listener_function, association);
     }
 
     rpcClientCallData* ClientManager::OpenDataFrameStream(const ommo::DataFrameStreamRequest& request, const std::function<void(const ommo::DataFrame&)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association)
     {
-        return new rpcOpenDataFrameStreamClientCallData(channel_, &completion_queue_, request, listener_function, association);
+        // A data frame contains multiple devices, so the stream is pinned by its owner instead.
+        // Streams replacing each other for the same owner are then always processed on the same queue.
+        CompletionQueue* cq = GetCompletionQueue(reinterpret_cast<uintptr_t>(association.lock().get()));
+        return new rpcOpenDataFrameStreamClientCallData(stub_, cq, request, listener_function, association);
+    }
+
+    rpcClientCallData* ClientManager::OpenEncodedTrackingDeviceDataStream(const ommo::TrackingDeviceDataStreamRequest& request, const std::function<void(const uint8_t*, size_t)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association)
+    {
+        CompletionQueue* cq = GetCompletionQueue(api::Hash(request.siu_uuid(), request.port_id()));
+        return new RpcEncodedStreamClientCallData(stub_, generic_stub_, cq, "/ommo.CoreService/OpenTrackingDeviceDataStream", request, listener_function, association);
+    }
+
+    rpcClientCallData* ClientManager::OpenEncodedDataFrameStream(const ommo::DataFrameStreamRequest& request, const std::function<void(const uint8_t*, size_t)> listener_function, std::weak_ptr<ommo::CallDataAssociation> association)
+    {
+        CompletionQueue* cq = GetCompletionQueue(reinterpret_cast<uintptr_t>(association.lock().get()));
+        return new RpcEncodedStreamClientCallData(stub_, generic_stub_, cq, "/ommo.CoreService/OpenDataFrameStream", request, listener_function, association);
     }
 
     rpcClientCallData* ClientManager::OpenTrackingDevicesEventStream(const ommo::TrackingDevicesEventStreamRequest& request, const std::function<void(const ommo::TrackingDeviceEvent&)> listener_function)
     {
-        return new rpcOpenTrackingDevicesEventStreamClientCallData(channel_, &completion_queue_, request, listener_function);
+        return new rpcOpenTrackingDevicesEventStreamClientCallData(stub_, GetCompletionQueue(control_stream_affinity_key), request, listener_function);
     }
 
     rpcClientCallData* ClientManager::OpenBaseStationDataStream(const ommo::BaseStationDataStreamRequest &request, const std::function<void(const ommo::BaseStationData&)> cb_handler, std::weak_ptr<ommo::CallDataAssociation> association)
     {
-        return new RpcBaseStationDataStreamClientCallData(channel_, &completion_queue_, request, cb_handler, association);
+        return new RpcBaseStationDataStreamClientCallData(stub_, GetCompletionQueue(control_stream_affinity_key), request, cb_handler, association);
     }
 
     rpcClientCallData* ClientManager::OpenTrackingGroupDataStream(const ommo::TrackingGroupDataStreamRequest &request, const std::function<void(const ommo::DataFrame&)> cb_handler, std::weak_ptr<ommo::CallDataAssociation> association)
     {
-        return new RpcTrackingGroupDataStreamClientCallData(channel_, &completion_queue_, request, cb_handler, association);
+        CompletionQueue* cq = GetCompletionQueue(api::Hash(request.siu_uuid(), request.port_id()));
+        return new RpcTrackingGroupDataStreamClientCallData(stub_, cq, request, cb_handler, association);
     }
 
     rpcClientCallData* ClientManager::OpenTrackingGroupsEventStream(const ommo::TrackingGroupsEventStreamRequest &request, const std::function<void(const ommo::TrackingGroupEvent&)> cb_handler)
     {
-        return new RpcTrackingGroupsEventStreamClientCallData(channel_, &completion_queue_, request, cb_handler);
+        return new RpcTrackingGroupsEventStreamClientCallData(stub_, GetCompletionQueue(control_stream_affinity_key), request, cb_handler);
     }
 
     RpcWirelessManagementStreamClientCallData* ClientManager::OpenWirelessManagementStream(const std::function<void(const ommo::WirelessManagementEvent&)> cb_handler, std::weak_ptr<ommo::CallDataAssociation> association)
     {
-        return new RpcWirelessManagementStreamClientCallData(channel_, &completion_queue_, cb_handler, association);
+        return new RpcWirelessManagementStreamClientCallData(stub_, GetCompletionQueue(control_stream_affinity_key), cb_handler, association);
+    }
+
+    CompletionQueue* ClientManager::GetCompletionQueue(uint64_t affinity_key)
+    {
+        return completion_queues_[AffinityIndex(affinity_key, completion_queues_.size())].get();
     }
 
     api::TrackingDevicesUPtr ClientManager::GetTrackingDevices()
@@ -83,9 +150,8 @@ namespace ommo
         ommo::TrackingDevicesRequest blank_request;
         ommo::TrackingDevices reply;
 
-        std::unique_ptr<ommo::CoreService::Stub> stub = ommo::CoreService::NewStub(channel_);
         ClientContext grpc_client_context;
-        Status status = stub->GetTrackingDevices(&grpc_client_context, blank_request, &reply);
+        Status status = stub_->GetTrackingDevices(&grpc_client_context, blank_request, &reply);
 
         if (status.ok())
         {
@@ -104,9 +170,8 @@ namespace ommo
         ommo::HardwareStatesRequest blank_request;
         ommo::HardwareStates reply;
 
-        std::unique_ptr<ommo::CoreService::Stub> stub = ommo::CoreService::NewStub(channel_);
         ClientContext grpc_client_context;
-        Status status = stub->GetHardwareStates(&grpc_client_context, blank_request, &reply);
+        Status status = stub_->GetHardwareStates(&grpc_client_context, blank_request, &reply);
 
         if (status.ok())
         {
@@ -126,9 +191,8 @@ namespace ommo
         request.set_active(active);
         ommo::BaseStationMotorRunningResponse reply;
 
-        std::unique_ptr<ommo::CoreService::Stub> stub = ommo::CoreService::NewStub(channel_);
         ClientContext grpc_client_context;
-        Status status = stub->SetBaseStationMotorRunning(&grpc_client_context, request, &reply);
+        Status status = stub_->SetBaseStationMotorRunning(&grpc_client_context, request, &reply);
 
         if (status.ok())
         {
@@ -145,16 +209,15 @@ namespace ommo
 
     void ClientManager::ChannelMonitor()
     {
-        while (!stop_channel_monitor_)
+        if (channel_ == nullptr)
         {
-            if (channel_ == nullptr)
-            {
-                OMMOLOG_ERROR("Channel is null. Exiting ChannelMonitor");
-                return;
-            }
-
-            int state = channel_->GetState(true);
+            OMMOLOG_ERROR("Channel is null. Exiting ChannelMonitor");
+            return;
+        }
 
+        int state = channel_->GetState(true);
+        while (true)
+        {
             // -1 is an invalid channel state. It's only used to detect initial startup condition
             if (-1 == previous_channel_state_ || state != previous_channel_state_)
             {
@@ -229,9 +292,36 @@ namespace ommo
                 }
             }
 
-            // Sleep for <interval> before checking the gRPC channel state again
-            std::this_thread::sleep_for(std::chrono::seconds(check_channel_interval));
+            // Wait until the channel state changes or Shutdown wakes us up. The watch is left outstanding on Shutdown,
+            // a monitor started again picks it up, otherwise it completes when the channel is destroyed.
+            if (!channel_watch_pending_)
+            {
+                channel_->NotifyOnStateChange(static_cast<grpc_connectivity_state>(state),
+                    std::chrono::system_clock::now() + channel_watch_timeout, monitor_cq_.get(), channel_state_changed_tag);
+                channel_watch_pending_ = true;
+            }
+            void* tag;
+            bool ok;
+            if (!monitor_cq_->Next(&tag, &ok) || tag == channel_monitor_wake_tag)
+            {
+                // Shutdown is the only way out
+                break;
+            }
+            if (tag == device_event_batch_tag)
+            {
+                // A cancelled alarm completes with ok set to false. The outstanding watch is not re-armed.
+                if (ok)
+                {
+                    ApplyDeviceEventBatch();
+                }
+                continue;
+            }
+
+            // Requesting the state with try_to_connect keeps an idle channel reconnecting
+            channel_watch_pending_ = false;
+            state = channel_->GetState(true);
         }
+
         OMMOLOG_INFO("Channel monitor stopped");
         if (device_event_stream_ptr_ != nullptr)
         {
@@ -242,7 +332,7 @@ namespace ommo
         }
     }
 
-    void ClientManager::CompletionQueueProcessor()
+    void ClientManager::CompletionQueueProcessor(CompletionQueue* completion_queue)
     {
         void* tag;
         bool ok;
@@ -253,7 +343,7 @@ namespace ommo
             // memory address of a CallData instance.
             // The return value of Next should always be checked. This return value
             // tells us whether there is any kind of event or cq_ is shutting down.
-            if (!completion_queue_.Next(&tag, &ok))
+            if (!completion_queue->Next(&tag, &ok))
             {
                 // Server shutting down
                 OMMOLOG_INFO("Completion Queue is fully drained or is shutting down. Stopping the handling of Completion Queue events");
@@ -310,17 +400,18 @@ namespace ommo
         }
         lock.unlock();
 
-        // Update all data managers according to the device event.
+        // Update the data managers interested in the device according to the device event.
         std::unique_lock<std::mutex> lk(data_manager_list_mutex_);
-        for (auto& data_manager_ptr : data_manager_list_)
+        for (auto& data_manager_ptr : all_devices_data_managers_)
         {
-            if (data_manager_ptr->GetDataStreamType() == api::DataStreamType::kDeviceData)
-            {
-                UpdateDeviceDataStream(data_manager_ptr, event_ptr->device, device_connected);
-            }
-            else if (data_manager_ptr->GetDataStreamType() == api::DataStreamType::kDataFrame)
+            RouteDeviceEvent(data_manager_ptr, event_ptr->device, device_connected);
+        }
+        auto routed = device_routing_index_.find(device_hash);
+        if (routed != device_routing_index_.end())
+        {
+            for (auto& data_manager_ptr : routed->second)
             {
-                UpdateDataFrameStream(data_manager_ptr, event_ptr->device, device_connected);
+                RouteDeviceEvent(data_manager_ptr, event_ptr->device, device_connected);
             }
         }
         lk.unlock();
@@ -332,6 +423,61 @@ namespace ommo
         }
     }
 
+    void ClientManager::RouteDeviceEvent(const std::shared_ptr<DataManager>& data_manager_ptr, api::DeviceDescriptor& device, bool device_connected)
+    {
+        if (data_manager_ptr->GetDataStreamType() == api::DataStreamType::kDeviceData)
+        {
+            UpdateDeviceDataStream(data_manager_ptr, device, device_connected);
+        }
+        else if (data_manager_ptr->GetDataStreamType() == api::DataStreamType::kDataFrame)
+        {
+            UpdateDataFrameStream(data_manager_ptr, device, device_connected);
+        }
+    }
+
+    void ClientManager::AddDataManager(const std::shared_ptr<DataManager>& data_manager_ptr)
+    {
+        data_manager_list_.emplace_back(data_manager_ptr);
+
+        if (data_manager_ptr->IsAllDevicesRequested())
+        {
+            all_devices_data_managers_.emplace_back(data_manager_ptr);
+            return;
+        }
+
+        // The hashes are unique, so each DataManager is indexed once per device
+        for (uint64_t device_hash : data_manager_ptr->GetRequestedDeviceHashes())
+        {
+            device_routing_index_[device_hash].emplace_back(data_manager_ptr);
+        }
+    }
+
+    void ClientManager::RemoveDataManager(const std::shared_ptr<DataManager>& data_manager_ptr)
+    {
+        data_manager_list_.erase(std::remove(data_manager_list_.begin(), data_manager_list_.end(), data_manager_ptr), data_manager_list_.end());
+
+        if (data_manager_ptr->IsAllDevicesRequested())
+        {
+            all_devices_data_managers_.erase(std::remove(all_devices_data_managers_.begin(), all_devices_data_managers_.end(), data_manager_ptr), all_devices_data_managers_.end());
+            return;
+        }
+
+        for (uint64_t device_hash : data_manager_ptr->GetRequestedDeviceHashes())
+        {
+            auto item = device_routing_index_.find(device_hash);
+            if (item == device_routing_index_.end())
+            {
+                continue;
+            }
+            std::vector<std::shared_ptr<DataManager>>& interested = item->second;
+            interested.erase(std::remove(interested.begin(), interested.end(), data_manager_ptr), interested.end());
+            if (interested.empty())
+            {
+                device_routing_index_.erase(item);
+            }
+        }
+    }
+
     void ClientManager::OpenDeviceDataStream(std::shared_ptr<DataManager> data_manager_ptr)
     {
         if (nullptr == data_manager_ptr || data_manager_ptr->GetDataStreamType() != api::DataStreamType::kDeviceData)
@@ -377,30 +523,64 @@ namespace ommo
                 data_manager_ptr->AddDeviceStorage(device);
             }
 
-            // if listener not exist. open data stream.
+            // if listener not exist. subscribe to the data stream.
             if (!data_manager_ptr->DataStreamExists(device_id))
             {
-                OMMOLOG_INFO("Opening DataStream for device siu_uuid={} port_id={}.", device.siu_uuid, device.port_id);
-
-                const api::DataRequest& data_request = data_manager_ptr->GetDataRequest();
-                // Set request for this device.
-                ommo::TrackingDeviceDataStreamRequest req;
-                req.set_siu_uuid(device.siu_uuid);
-                req.set_port_id(device.port_id);
-                req.set_field_mask(data_request.data_field_mask);
-                req.set_include_raw_sensor_data(data_request.include_raw_sensor_data);
-                req.set_report_interval(data_request.report_interval);
-                req.set_buffer_depth(data_request.buffer_depth);
-                req.set_requested_fusion_mode(ommo::DeviceFusionModeToProto(data_request.requested_fusion_mode));
-                // Open data stream.
-                rpcClientCallData* call_data_ptr = OpenTrackingDeviceDataStream(req, std::bind(&DataManager::UpdateDeviceData, data_manager_ptr.get(), std::placeholders::_1), data_manager_ptr);
                 // Save data stream pointer in data manager.
-                data_manager_ptr->AddDataStream(device_id, call_data_ptr);
+                data_manager_ptr->AddDataStream(device_id, AcquireDeviceDataStream(data_manager_ptr, device));
+            }
+        }
+    }
+
+    std::shared_ptr<SharedDeviceDataStream> ClientManager::AcquireDeviceDataStream(const std::shared_ptr<DataManager>& data_manager_ptr, const api::DeviceDescriptor& device)
+    {
+        const api::DataRequest& data_request = data_manager_ptr->GetDataRequest();
+        DeviceDataStreamKey key{ device.siu_uuid, device.port_id, data_request.data_field_mask, data_request.requested_fusion_mode,
+            data_request.include_raw_sensor_data, data_request.report_interval, data_request.buffer_depth };
+
+        std::unique_lock<std::mutex> lock(shared_device_streams_mutex_);
+        auto item = shared_device_streams_.find(key);
+        if (item != shared_device_streams_.end())
+        {
+            // Join the existing stream unless it already ended
+            std::shared_ptr<SharedDeviceDataStream> stream = item->second.lock();
+            if (stream && stream->AddSubscriber(data_manager_ptr))
+            {
+                OMMOLOG_INFO("Joining DataStream for device siu_uuid={} port_id={}.", device.siu_uuid, device.port_id);
+                return stream;
             }
         }
+
+        OMMOLOG_INFO("Opening DataStream for device siu_uuid={} port_id={}.", device.siu_uuid, device.port_id);
+        std::shared_ptr<SharedDeviceDataStream> stream = std::make_shared<SharedDeviceDataStream>(key);
+        stream->AddSubscriber(data_manager_ptr);
+        shared_device_streams_[key] = stream;
+
+        // Drop entries of streams that no longer exist
+        for (auto it = shared_device_streams_.begin(); it != shared_device_streams_.end();)
+        {
+            it = it->second.expired() ? shared_device_streams_.erase(it) : std::next(it);
+        }
+        lock.unlock();
+
+        // Set request for this device.
+        ommo::TrackingDeviceDataStreamRequest req;
+        req.set_siu_uuid(device.siu_uuid);
+        req.set_port_id(device.port_id);
+        req.set_field_mask(data_request.data_field_mask);
+        req.set_include_raw_sensor_data(data_request.include_raw_sensor_data);
+        req.set_report_interval(data_request.report_interval);
+        req.set_buffer_depth(data_request.buffer_depth);
+        req.set_requested_fusion_mode(ommo::DeviceFusionModeToProto(data_request.requested_fusion_mode));
+        // Open data stream. The call data keeps the stream alive until it is deleted.
+        rpcClientCallData* call_data_ptr = wire_decoding_
+            ? OpenEncodedTrackingDeviceDataStream(req, [stream](const uint8_t* data, size_t size) { stream->Publish(data, size); }, stream)
+            : OpenTrackingDeviceDataStream(req, [stream](const ommo::TrackingDeviceData& packet) { stream->Publish(packet); }, stream);
+        stream->SetCallData(call_data_ptr);
+        return stream;
     }
 
-    void ClientManager::OpenDataFrame(std::shared_ptr<DataManager> data_manager_ptr)
+    void ClientManager::OpenDataFrame(std::shared_ptr<DataManager> data_manager_ptr, bool make_before_break)
     {
         if (nullptr == data_manager_ptr || data_manager_ptr->GetDataStreamType() != api::DataStreamType::kDataFrame)
         {
@@ -415,6 +595,9 @@ namespace ommo
         req.set_report_interval(data_request.report_interval);
         req.set_buffer_depth(data_request.buffer_depth);
 
+        // Resolve the storage slots of the requested devices once for the whole stream
+        DeviceStorageSlotTable slots;
+
         std::unique_lock<std::mutex> lock(connected_devices_mtx_);
         for (auto& device_item : connected_devices_)
         {
@@ -433,13 +616,20 @@ namespace ommo
                     OMMOLOG_INFO("Creating data storage for device siu_uuid={} port_id={}.", device_item.second->siu_uuid, device_item.second->port_id);
                     data_manager_ptr->AddDeviceStorage(*device_item.second);
                 }
+                slots.emplace_back(device_item.first, data_manager_ptr->GetStorageSlot(device_item.first));
             }
         }
         lock.unlock();
 
+        // A stream without devices never delivers a frame to switch over on, so replace the current stream right away
+        const uint64_t generation = data_manager_ptr->BeginDataFrameStream(make_before_break && req.tracking_devices_size() > 0);
+
         // Make request for data frame.
-        rpcClientCallData* call_data_ptr = OpenDataFrameStream(req, std::bind(&DataManager::UpdateDataFrame, data_manager_ptr.get(), std::placeholders::_1), data_manager_ptr);
-        data_manager_ptr->SetDataFrameStream(call_data_ptr);
+        DataManager* data_manager = data_manager_ptr.get();
+        rpcClientCallData* call_data_ptr = wire_decoding_
+            ? OpenEncodedDataFrameStream(req, [data_manager, generation, slots = std::move(slots)](const uint8_t* data, size_t size) { data_manager->UpdateDataFrame(data, size, generation, slots); }, data_manager_ptr)
+            : OpenDataFrameStream(req, [data_manager, generation, slots = std::move(slots)](const ommo::DataFrame& packet) { data_manager->UpdateDataFrame(packet, generation, slots); }, data_manager_ptr);
+        data_manager_ptr->SetDataFrameStream(call_data_ptr, generation);
     }
 
     void ClientManager::UpdateDataFrameStream(std::shared_ptr<DataManager> data_manager_ptr, api::DeviceDescriptor& device, bool device_connected)
@@ -460,27 +650,100 @@ namespace ommo
         }
 
         // Always replace the old data stream with the new one, regardless of whether the device is connected or removed.
-        data_manager_ptr->CancelDataFrameStream();
-        data_manager_ptr->RemoveDataFrameStream();
+        // The old stream keeps delivering frames for the other devices until the new one is up.
+        ScheduleDataFrameReopen(data_manager_ptr);
+    }
 
-        // Start new data frame listener.
-        OpenDataFrame(data_manager_ptr);
+    void ClientManager::ScheduleDataFrameReopen(std::shared_ptr<DataManager> data_manager_ptr)
+    {
+        std::unique_lock<std::mutex> lock(device_event_batch_mutex_);
+        if (device_event_batching_stopped_)
+        {
+            // Shutting down, the data frame streams are cancelled and the monitor may no longer wait on its queue
+            return;
+        }
+
+        const uint32_t window_ms = device_event_batch_window_ms_;
+        if (window_ms == 0 || device_event_batch_alarm_ == nullptr)
+        {
+            // No batching or no channel monitor to apply the batch. Reopen right away.
+            lock.unlock();
+            OpenDataFrame(data_manager_ptr, true);
+            return;
+        }
+
+        pending_dataframe_reopens_.insert(data_manager_ptr);
+        // The window starts with the first event of a batch. Later events join the batch without extending it.
+        if (!device_event_batch_pending_)
+        {
+            device_event_batch_pending_ = true;
+            device_event_batch_alarm_->Set(monitor_cq_.get(), std::chrono::system_clock::now() + std::chrono::milliseconds(window_ms), device_event_batch_tag);
+        }
+    }
+
+    void ClientManager::ApplyDeviceEventBatch()
+    {
+        std::unique_lock<std::mutex> lock(device_event_batch_mutex_);
+        std::unordered_set<std::shared_ptr<DataManager>> pending_reopens;
+        pending_reopens.swap(pending_dataframe_reopens_);
+        device_event_batch_pending_ = false;
+        lock.unlock();
+
+        std::unique_lock<std::mutex> lk(data_manager_list_mutex_);
+        for (auto& data_manager_ptr : pending_reopens)
+        {
+            // Skip requests closed while the batch was pending
+            if (std::find(data_manager_list_.begin(), data_manager_list_.end(), data_manager_ptr) == data_manager_list_.end())
+            {
+                continue;
+            }
+            OMMOLOG_INFO("Reopening data frame stream after device events");
+            OpenDataFrame(data_manager_ptr, true);
+        }
+    }
+
+    void ClientManager::SetDeviceEventBatchWindow(uint32_t milliseconds)
+    {
+        device_event_batch_window_ms_ = milliseconds;
+    }
+
+    void ClientManager::SetWireDecoding(bool enabled)
+    {
+        wire_decoding_ = enabled;
+    }
+
+    void ClientManager::SetColumnarHistory(bool enabled)
+    {
+        columnar_history_ = enabled;
+    }
+
+    void ClientManager::SetConvertOnRead(bool enabled)
+    {
+        convert_on_read_ = enabled;
     }
 
     void ClientManager::Start()
     {
         if (channel_monitor_thread_.get() == nullptr)
         {
-            stop_channel_monitor_ = false;
+            channel_monitor_wake_alarm_ = std::make_unique<grpc::Alarm>();
+            std::unique_lock<std::mutex> lock(device_event_batch_mutex_);
+            device_event_batch_alarm_ = std::make_unique<grpc::Alarm>();
+            device_event_batch_pending_ = false;
+            device_event_batching_stopped_ = false;
+            lock.unlock();
             OMMOLOG_INFO("Starting connection monitor thread");
             channel_monitor_thread_ = std::make_unique<std::thread>(std::bind(&ClientManager::ChannelMonitor, this));
         }
 
-        if (handle_cq_thread_.get() == nullptr)
+        if (handle_cq_threads_.empty())
         {
             stop_handling_cq_ = false;
-            OMMOLOG_INFO("Starting completion queue processor thread");
-            handle_cq_thread_ = std::make_unique<std::thread>(std::bind(&ClientManager::CompletionQueueProcessor, this));
+            OMMOLOG_INFO("Starting {} completion queue processor thread(s)", completion_queues_.size());
+            for (auto& completion_queue : completion_queues_)
+            {
+                handle_cq_threads_.emplace_back(std::make_unique<std::thread>(std::bind(&ClientManager::CompletionQueueProcessor, this, completion_queue.get())));
+            }
         }
     }
 
@@ -512,30 +775,56 @@ namespace ommo
         }
 
         OMMOLOG_INFO("Stopping channel monitor");
-        stop_channel_monitor_ = true;
         if (channel_monitor_thread_.get() != nullptr)
         {
+            // Drop any pending device event batch. The streams it would reopen are cancelled above.
+            // Events arriving from now on are ignored, so nothing sets the alarm again.
+            std::unique_lock<std::mutex> batch_lock(device_event_batch_mutex_);
+            device_event_batching_stopped_ = true;
+            if (device_event_batch_pending_)
+            {
+                device_event_batch_alarm_->Cancel();
+                device_event_batch_pending_ = false;
+            }
+            pending_dataframe_reopens_.clear();
+            batch_lock.unlock();
+
+            // Fire the alarm right away to wake the monitor, which only stops on this tag
+            channel_monitor_wake_alarm_->Set(monitor_cq_.get(), std::chrono::system_clock::now(), channel_monitor_wake_tag);
             channel_monitor_thread_->join();
             channel_monitor_thread_.reset();
+            channel_monitor_wake_alarm_.reset();
+            batch_lock.lock();
+            device_event_batch_alarm_.reset();
+            batch_lock.unlock();
         }
 
-        OMMOLOG_INFO("Shutting down completion queue");
-        completion_queue_.Shutdown();
+        // Calls without a deadline would keep the completion queues from draining
+        OMMOLOG_INFO("Cancelling all unary calls");
+        unary_calls_->Stop();
 
-        OMMOLOG_INFO("Stopping completion queue processor");
+        OMMOLOG_INFO("Shutting down completion queues");
+        for (auto& completion_queue : completion_queues_)
+        {
+            completion_queue->Shutdown();
+        }
+
+        OMMOLOG_INFO("Stopping completion queue processors");
         stop_handling_cq_ = true;
-        if (handle_cq_thread_.get() != nullptr)
+        for (auto& handle_cq_thread : handle_cq_threads_)
         {
-            if (handle_cq_thread_->joinable())
+            if (handle_cq_thread->joinable())
             {
-                handle_cq_thread_->join();
-                handle_cq_thread_.reset();
+                handle_cq_thread->join();
             }
         }
+        handle_cq_threads_.clear();
 
         // Remove all created DataManagers to release our hold on the shared pointers
         // This is so they can be deleted if no one else is using them
         data_manager_list_.clear();
+        device_routing_index_.clear();
+        all_devices_data_managers_.clear();
     }
 
     void ClientManager::RegisterDeviceEventCallback(std::function<void(const api::TrackingDeviceEvent&)> callback_function)
@@ -561,10 +850,10 @@ namespace ommo
     std::shared_ptr<DataManager> ClientManager::RequestDeviceData(api::DataRequest& request)
     {
         // Create data manager for request.
-        std::shared_ptr<DataManager> data_manager_ptr = std::make_shared<DataManager>(request, api::DataStreamType::kDeviceData);
+        std::shared_ptr<DataManager> data_manager_ptr = std::make_shared<DataManager>(request, api::DataStreamType::kDeviceData, columnar_history_, convert_on_read_);
 
         std::unique_lock<std::mutex> lk(data_manager_list_mutex_);
-        data_manager_list_.emplace_back(data_manager_ptr);
+        AddDataManager(data_manager_ptr);
         lk.unlock();
 
         // Check current device state and open device data stream for data manager.
@@ -576,10 +865,10 @@ namespace ommo
     std::shared_ptr<DataManager> ClientManager::RequestDataFrame(api::DataRequest& request)
     {
         // Create data manager for request.
-        std::shared_ptr<DataManager> data_manager_ptr = std::make_shared<DataManager>(request, api::DataStreamType::kDataFrame);
+        std::shared_ptr<DataManager> data_manager_ptr = std::make_shared<DataManager>(request, api::DataStreamType::kDataFrame, columnar_history_, convert_on_read_);
 
         std::unique_lock<std::mutex> lk(data_manager_list_mutex_);
-        data_manager_list_.emplace_back(data_manager_ptr);
+        AddDataManager(data_manager_ptr);
         lk.unlock();
 
         // Check current device state and open data frame stream for data manager.
@@ -652,14 +941,7 @@ namespace ommo
         // Remove from client's data manager list.
         OMMOLOG_INFO("Removing data manager");
         std::unique_lock<std::mutex> lk(data_manager_list_mutex_);
-        for (auto it = data_manager_list_.begin(); it != data_manager_list_.end(); it++)
-        {
-            if (*it == data_manager_ptr)
-            {
-                data_manager_list_.erase(it);
-                break;
-            }
-        }
+        RemoveDataManager(data_manager_ptr);
         lk.unlock();
     }
 
@@ -683,9 +965,8 @@ namespace ommo
         data_logging_request.set_overwrite(overwrite);
         ommo::DataLoggingResponse reply;
 
-        std::unique_ptr<ommo::CoreService::Stub> stub = ommo::CoreService::NewStub(channel_);
         ClientContext grpc_client_context;
-        Status status = stub->SendDataLoggingRequest(&grpc_client_context, data_logging_request, &reply);
+        Status status = stub_->SendDataLoggingRequest(&grpc_client_context, data_logging_request, &reply);
 
         if (status.ok())
         {
@@ -703,9 +984,8 @@ namespace ommo
         data_logging_request.set_enable_logging(false);
         ommo::DataLoggingResponse reply;
 
-        std::unique_ptr<ommo::CoreService::Stub> stub = ommo::CoreService::NewStub(channel_);
         ClientContext grpc_client_context;
-        Status status = stub->SendDataLoggingRequest(&grpc_client_context, data_logging_request, &reply);
+        Status status = stub_->SendDataLoggingRequest(&grpc_client_context, data_logging_request, &reply);
 
         if (status.ok())
         {
@@ -766,9 +1046,8 @@ namespace ommo
         ommo::SelectReferenceDeviceRequest proto_request = ommo::SelectReferenceDeviceRequestToProto(request);
         ommo::SelectReferenceDeviceResponse reply;
 
-        std::unique_ptr<ommo::CoreService::Stub> stub = ommo::CoreService::NewStub(channel_);
         ClientContext grpc_client_context;
-        Status status = stub->SelectReferenceDevice(&grpc_client_context, proto_request, &reply);
+        Status status = stub_->SelectReferenceDevice(&grpc_client_context, proto_request, &reply);
 
         if (status.ok())
         {
@@ -780,4 +1059,148 @@ namespace ommo
             return false;
         }
     }
+
+    template <typename Request, typename Response>
+    void ClientManager::StartUnaryCall(
+        std::unique_ptr<ClientAsyncResponseReader<Response>> (ommo::CoreService::Stub::*prepare_function)(ClientContext*, const Request&, CompletionQueue*),
+        const Request& request,
+        uint32_t timeout_ms,
+        const std::function<void(const Status&, Response&)>& handler)
+    {
+        // Call data is deleted by the completion queue processor once the call completes
+        const bool started = unary_calls_->StartCall([&]() -> rpcClientCallData*
+            {
+                return new RpcUnaryClientCallData<Request, Response>(
+                    stub_, GetCompletionQueue(control_stream_affinity_key), prepare_function, request, timeout_ms, handler, unary_calls_);
+            });
+        if (!started)
+        {
+            Response response;
+            handler(Status(grpc::StatusCode::UNAVAILABLE, "Client is shut down"), response);
+        }
+    }
+
+    void ClientManager::GetTrackingDevicesAsync(std::function<void(api::TrackingDevicesUPtr)> callback, uint32_t timeout_ms)
+    {
+        StartUnaryCall<ommo::TrackingDevicesRequest, ommo::TrackingDevices>(
+            &ommo::CoreService::Stub::PrepareAsyncGetTrackingDevices, ommo::TrackingDevicesRequest(), timeout_ms,
+            [callback](const Status& status, ommo::TrackingDevices& reply)
+            {
+                if (!status.ok())
+                {
+                    OMMOLOG_ERROR("GetTrackingDevices RPC failed. code={} message={}", static_cast<int>(status.error_code()), status.error_message());
+                    reply.Clear();
+                }
+                if (callback)
+                {
+                    callback(ommo::ProtoToTrackingDevices(reply));
+                }
+            });
+    }
+
+    void ClientManager::GetHardwareStatesAsync(std::function<void(api::HardwareStatesUPtr)> callback, uint32_t timeout_ms)
+    {
+        StartUnaryCall<ommo::HardwareStatesRequest, ommo::HardwareStates>(
+            &ommo::CoreService::Stub::PrepareAsyncGetHardwareStates, ommo::HardwareStatesRequest(), timeout_ms,
+            [callback](const Status& status, ommo::HardwareStates& reply)
+            {
+                if (!status.ok())
+                {
+                    OMMOLOG_ERROR("GetHardwareStates RPC failed. code={} message={}", static_cast<int>(status.error_code()), status.error_message());
+                    reply.Clear();
+                }
+                if (callback)
+                {
+                    callback(ommo::ProtoToHardwareStates(reply));
+                }
+            });
+    }
+
+    void ClientManager::SetBaseStationMotorRunningAsync(bool active, std::function<void(bool)> callback, uint32_t timeout_ms)
+    {
+        ommo::BaseStationMotorRunningRequest request;
+        request.set_active(active);
+
+        StartUnaryCall<ommo::BaseStationMotorRunningRequest, ommo::BaseStationMotorRunningResponse>(
+            &ommo::CoreService::Stub::PrepareAsyncSetBaseStationMotorRunning, request, timeout_ms,
+            [callback](const Status& status, ommo::BaseStationMotorRunningResponse& reply)
+            {
+                if (!status.ok())
+                {
+                    OMMOLOG_ERROR("SetBaseStationMotorRunning RPC failed. code={} message={}", static_cast<int>(status.error_code()), status.error_message());
+                }
+                if (callback)
+                {
+                    callback(status.ok() && reply.success());
+                }
+            });
+    }
+
+    void ClientManager::EnableDataLoggingAsync(std::string directory, std::string file_name, bool overwrite, std::function<void(api::DataLogState)> callback, uint32_t timeout_ms)
+    {
+        // If overwrite is false, check if the file already exists.
+        if (!overwrite)
+        {
+            auto full_path = std::filesystem::path(directory) / file_name;
+            if (std::filesystem::exists(full_path))
+            {
+                SPDLOG_ERROR("File already exists. Overwrite is set to false. Logging request will not be sent.");
+                if (callback)
+                {
+                    callback(api::DataLogState::kError);
+                }
+                return;
+            }
+        }
+
+        ommo::DataLoggingRequest data_logging_request;
+        data_logging_request.set_enable_logging(true);
+        data_logging_request.set_directory(directory);
+        data_logging_request.set_file_name(file_name);
+        data_logging_request.set_overwrite(overwrite);
+
+        StartUnaryCall<ommo::DataLoggingRequest, ommo::DataLoggingResponse>(
+            &ommo::CoreService::Stub::PrepareAsyncSendDataLoggingRequest, data_logging_request, timeout_ms,
+            [callback](const Status& status, ommo::DataLoggingResponse& reply)
+            {
+                if (callback)
+                {
+                    callback(status.ok() ? ommo::ProtoToDataLogState(reply.log_state()) : api::DataLogState::kRpcFail);
+                }
+            });
+    }
+
+    void ClientManager::DisableDataLoggingAsync(std::function<void(api::DataLogState)> callback, uint32_t timeout_ms)
+    {
+        ommo::DataLoggingRequest data_logging_request;
+        data_logging_request.set_enable_logging(false);
+
+        StartUnaryCall<ommo::DataLoggingRequest, ommo::DataLoggingResponse>(
+            &ommo::CoreService::Stub::PrepareAsyncSendDataLoggingRequest, data_logging_request, timeout_ms,
+            [callback](const Status& status, ommo::DataLoggingResponse& reply)
+            {
+                if (callback)
+                {
+                    callback(status.ok() ? ommo::ProtoToDataLogState(reply.log_state()) : api::DataLogState::kRpcFail);
+                }
+            });
+    }
+
+    void ClientManager::SelectReferenceDeviceAsync(bool enabled, uint32_t siu_uuid, uint32_t port_num, std::function<void(bool)> callback, uint32_t timeout_ms)
+    {
+        api::SelectReferenceDeviceRequest request;
+        request.enabled = enabled;
+        request.siu_uuid = siu_uuid;
+        request.port_num = port_num;
+
+        StartUnaryCall<ommo::SelectReferenceDeviceRequest, ommo::SelectReferenceDeviceResponse>(
+            &ommo::CoreService::Stub::PrepareAsyncSelectReferenceDevice, ommo::SelectReferenceDeviceRequestToProto(request), timeout_ms,
+            [callback](const Status& status, ommo::SelectReferenceDeviceResponse& reply)
+            {
+                if (callback)
+                {
+                    callback(status.ok() && ommo::ProtoToSelectReferenceDeviceResponse(reply).success);
+                }
+            });
+    }
 }  // namespace ommo
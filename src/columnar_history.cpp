@@ -0,0 +1,83 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#include "columnar_history.h"
+
+namespace ommo
+{
+
+    ColumnarHistory::ColumnarHistory(uint32_t row_count, uint32_t sensor_unit_count) : row_count_(row_count), sensor_unit_count_(sensor_unit_count)
+    {
+        const size_t column_size = static_cast<size_t>(row_count_) * sensor_unit_count_;
+        timestamps_ = std::make_unique<uint32_t[]>(row_count_);
+        float_columns_ = std::make_unique<float[]>(column_size * static_cast<size_t>(FloatColumn::kCount));
+        int_columns_ = std::make_unique<int32_t[]>(column_size * static_cast<size_t>(IntColumn::kCount));
+    }
+
+    void ColumnarHistory::WriteRow(uint32_t row, const api::TrackingDeviceData& data)
+    {
+        timestamps_[row] = data.timestamp;
+
+        for (uint32_t unit = 0; unit < sensor_unit_count_; unit++)
+        {
+            const api::PoseData pose = unit < data.pose_count ? data.poses[unit] : api::PoseData{};
+            FloatValue(FloatColumn::kPositionX, unit, row) = pose.position.x;
+            FloatValue(FloatColumn::kPositionY, unit, row) = pose.position.y;
+            FloatValue(FloatColumn::kPositionZ, unit, row) = pose.position.z;
+            FloatValue(FloatColumn::kQuaternionW, unit, row) = pose.quaternion.w;
+            FloatValue(FloatColumn::kQuaternionX, unit, row) = pose.quaternion.x;
+            FloatValue(FloatColumn::kQuaternionY, unit, row) = pose.quaternion.y;
+            FloatValue(FloatColumn::kQuaternionZ, unit, row) = pose.quaternion.z;
+            FloatValue(FloatColumn::kIndicatorValue, unit, row) = pose.indicator_value;
+            FloatValue(FloatColumn::kMotionIndicator, unit, row) = pose.motion_indicator;
+            FloatValue(FloatColumn::kBadDataIndicator, unit, row) = pose.bad_data_indicator;
+
+            const api::RawSensorData raw = unit < data.raw_sensor_data_count ? data.raw_sensor_data[unit] : api::RawSensorData{};
+            IntValue(IntColumn::kAccelX, unit, row) = raw.accel.x;
+            IntValue(IntColumn::kAccelY, unit, row) = raw.accel.y;
+            IntValue(IntColumn::kAccelZ, unit, row) = raw.accel.z;
+            IntValue(IntColumn::kGyroX, unit, row) = raw.gyro.x;
+            IntValue(IntColumn::kGyroY, unit, row) = raw.gyro.y;
+            IntValue(IntColumn::kGyroZ, unit, row) = raw.gyro.z;
+            IntValue(IntColumn::kMagX, unit, row) = raw.mag.x;
+            IntValue(IntColumn::kMagY, unit, row) = raw.mag.y;
+            IntValue(IntColumn::kMagZ, unit, row) = raw.mag.z;
+        }
+    }
+
+    uint32_t ColumnarHistory::GetSensorUnitCount() const
+    {
+        return sensor_unit_count_;
+    }
+
+    const uint32_t* ColumnarHistory::GetTimestamps() const
+    {
+        return timestamps_.get();
+    }
+
+    const float* ColumnarHistory::GetColumn(FloatColumn column, uint32_t sensor_unit) const
+    {
+        return &float_columns_[(static_cast<size_t>(column) * sensor_unit_count_ + sensor_unit) * row_count_];
+    }
+
+    const int32_t* ColumnarHistory::GetColumn(IntColumn column, uint32_t sensor_unit) const
+    {
+        return &int_columns_[(static_cast<size_t>(column) * sensor_unit_count_ + sensor_unit) * row_count_];
+    }
+
+    float& ColumnarHistory::FloatValue(FloatColumn column, uint32_t sensor_unit, uint32_t row)
+    {
+        return float_columns_[(static_cast<size_t>(column) * sensor_unit_count_ + sensor_unit) * row_count_ + row];
+    }
+
+    int32_t& ColumnarHistory::IntValue(IntColumn column, uint32_t sensor_unit, uint32_t row)
+    {
+        return int_columns_[(static_cast<size_t>(column) * sensor_unit_count_ + sensor_unit) * row_count_ + row];
+    }
+
+}  // namespace ommo
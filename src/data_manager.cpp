@@ -6,18 +6,32 @@
  * OF ANY KIND, either express or implied.
 */
 
+#include <algorithm>
+
 #include "data_manager.h"
 #include "logger_base.h"
 #include "protobuf_converters.h"
 #include "sdk_utils.h"
+#include "wire_decoder.h"
 
 namespace ommo
 {
-    DataManager::DataManager(const api::DataRequest& request, api::DataStreamType stream_type)
+    DataManager::DataManager(const api::DataRequest& request, api::DataStreamType stream_type, bool store_columnar_history, bool convert_on_read)
         // make a deep copy of request
-        : stream_type_(stream_type)
+        : stream_type_(stream_type),
+        device_data_parts_(RequestedDeviceDataParts(request)),
+        store_columnar_history_(store_columnar_history),
+        convert_on_read_(convert_on_read)
     {
         api::MoveAndDeletePtr(request_, api::CopyDataRequest(request));
+
+        if (request_.requested_devices != nullptr)
+        {
+            for (int i = 0; i < request_.requested_device_count; i++)
+            {
+                requested_device_hashes_.insert(api::Hash(request_.requested_devices[i]));
+            }
+        }
     }
 
 
@@ -34,22 +48,23 @@ namespace ommo
     bool DataManager::IsDeviceDataRequested(const api::DeviceID& device_id)
     {
         // An empty request list means all devices are requested
-        if (request_.requested_devices == nullptr || request_.requested_device_count == 0)
+        if (IsAllDevicesRequested())
         {
             return true;
         }
 
         // If the user provided a request list, check if the specified device was included
-        for (int i = 0; i < request_.requested_device_count; i++)
-        {
-            if (device_id.siu_uuid == request_.requested_devices[i].siu_uuid && device_id.port_id == request_.requested_devices[i].port_id)
-            {
-                return true;
-            }
-        }
+        return requested_device_hashes_.count(api::Hash(device_id)) > 0;
+    }
 
-        // The device was not found in the request list
-        return false;
+    bool DataManager::IsAllDevicesRequested() const
+    {
+        return request_.requested_devices == nullptr || request_.requested_device_count == 0;
+    }
+
+    const std::unordered_set<uint64_t>& DataManager::GetRequestedDeviceHashes() const
+    {
+        return requested_device_hashes_;
     }
 
     api::DeviceIDListUPtr DataManager::GetDeviceStorageList()
@@ -68,6 +83,21 @@ namespace ommo
         return result;
     }
 
+    uint32_t DataManager::GetDeviceStorageList(api::DeviceIDBuffer& buffer)
+    {
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        buffer.device_count = 0;
+        for (auto& ele : device_data_map_)
+        {
+            if (buffer.device_count == buffer.device_capacity)
+            {
+                break;
+            }
+            buffer.devices[buffer.device_count++] = api::DeviceID{ ele.second->GetUUID(), ele.second->GetPortId() };
+        }
+        return static_cast<uint32_t>(device_data_map_.size());
+    }
+
     void DataManager::AddDeviceStorage(const api::DeviceDescriptor& device, int32_t buffer_size)
     {
         uint64_t hash = api::Hash(device);
@@ -76,7 +106,13 @@ namespace ommo
         // Check if the storage already exists before creating a new one
         if (device_data_map_.find(hash) == device_data_map_.end())
         {
-            device_data_map_.emplace(hash, std::make_unique<DeviceDataStorage>(device, buffer_size));
+            auto storage = std::make_shared<DeviceDataStorage>(device, buffer_size, store_columnar_history_, convert_on_read_, device_data_parts_);
+            device_data_map_.emplace(hash, storage);
+            auto slot = storage_slots_.find(hash);
+            if (slot != storage_slots_.end())
+            {
+                std::atomic_store(&slot->second->storage, storage);
+            }
             OMMOLOG_INFO("Adding data storage for device. Siu: {}, Port Id: {}", device.siu_uuid, device.port_id);
         }
     }
@@ -88,6 +124,11 @@ namespace ommo
         if (device_data_map_.find(hash) != device_data_map_.end())
         {
             device_data_map_.erase(hash);
+            auto slot = storage_slots_.find(hash);
+            if (slot != storage_slots_.end())
+            {
+                std::atomic_store(&slot->second->storage, std::shared_ptr<DeviceDataStorage>());
+            }
             OMMOLOG_INFO("Erasing data storage for {}", hash);
         }
     }
@@ -118,45 +159,190 @@ namespace ommo
         return IsStorageAvailable(Hash(device_id));
     }
 
-    void DataManager::UpdateDeviceData(const ommo::TrackingDeviceData& packet)
+    std::shared_ptr<DeviceStorageSlot> DataManager::GetStorageSlot(uint64_t hash)
     {
-        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        std::unique_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        std::shared_ptr<DeviceStorageSlot>& slot = storage_slots_[hash];
+        if (!slot)
+        {
+            slot = std::make_shared<DeviceStorageSlot>();
+            auto storage = device_data_map_.find(hash);
+            if (storage != device_data_map_.end())
+            {
+                std::atomic_store(&slot->storage, storage->second);
+            }
+        }
+        return slot;
+    }
 
-        uint64_t device_hash = api::Hash(packet.siu_uuid(), packet.port_id());
+    void DataManager::UpdateDeviceData(const ommo::TrackingDeviceData& packet, DeviceStorageSlot& slot)
+    {
+        if (device_data_user_callback_)
+        {
+            // Convert once for both the storage and the callback
+            UpdateDeviceData(ProtoToSharedTrackingDeviceData(packet, device_data_parts_), slot);
+            return;
+        }
 
-        auto storage = device_data_map_.find(device_hash);
-        if (storage != device_data_map_.end())
+        std::shared_ptr<DeviceDataStorage> storage = std::atomic_load(&slot.storage);
+        if (storage)
+        {
+            storage->PushData(packet);
+        }
+    }
+
+    void DataManager::UpdateDeviceData(const api::TrackingDeviceDataSPtr& packet, DeviceStorageSlot& slot)
+    {
+        std::shared_ptr<DeviceDataStorage> storage = std::atomic_load(&slot.storage);
+        if (storage)
         {
-            storage->second->PushData(packet);
+            storage->PushData(*packet);
         }
 
+        if (device_data_user_callback_ && !DispatchDeviceData(packet))
+        {
+            device_data_user_callback_(*packet);
+        }
+    }
+
+    void DataManager::UpdateDeviceData(const uint8_t* data, size_t size, DeviceStorageSlot& slot)
+    {
         if (device_data_user_callback_)
         {
-            // convert to api UPtr type to be automaitcally destroyed after callback
-            api::TrackingDeviceDataUPtr cb_packet = ProtoToTrackingDeviceData(packet);
-            device_data_user_callback_(*cb_packet);
+            // Decode once for both the storage and the callback
+            const api::TrackingDeviceDataSPtr packet = DecodeSharedTrackingDeviceData(data, size, device_data_parts_);
+            if (!packet)
+            {
+                OMMOLOG_WARN("Dropping malformed TrackingDeviceData.");
+                return;
+            }
+            UpdateDeviceData(packet, slot);
+            return;
+        }
+
+        std::shared_ptr<DeviceDataStorage> storage = std::atomic_load(&slot.storage);
+        if (storage && !storage->PushEncodedData(data, size))
+        {
+            OMMOLOG_WARN("Dropping malformed or misrouted TrackingDeviceData.");
         }
     }
 
-    void DataManager::UpdateDataFrame(const ommo::DataFrame& packet)
+    bool DataManager::AcceptDataFrame(uint64_t stream_generation)
     {
-        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        std::lock_guard<std::mutex> lock(dataframe_stream_mtx_);
+        if (stream_generation != 0 && stream_generation == pending_dataframe_stream_generation_)
+        {
+            // First frame of the replacement stream. Switch over and cancel the replaced stream.
+            if (dataframe_stream_)
+            {
+                dataframe_stream_->CancelCall();
+            }
+            dataframe_stream_ = pending_dataframe_stream_;
+            dataframe_stream_generation_ = stream_generation;
+            pending_dataframe_stream_ = nullptr;
+            pending_dataframe_stream_generation_ = 0;
+        }
+        else if (stream_generation != dataframe_stream_generation_)
+        {
+            // Frame of a stream that was already replaced
+            return false;
+        }
+        return true;
+    }
+
+    const DeviceStorageSlot* DataManager::FindStorageSlot(const DeviceStorageSlotTable& slots, size_t position, uint64_t device_hash)
+    {
+        // Frames normally list the devices in request order, so try the same position first
+        if (position < slots.size() && slots[position].first == device_hash)
+        {
+            return slots[position].second.get();
+        }
+        auto item = std::find_if(slots.begin(), slots.end(), [device_hash](const auto& entry) { return entry.first == device_hash; });
+        return item != slots.end() ? item->second.get() : nullptr;
+    }
+
+    void DataManager::UpdateDataFrame(const ommo::DataFrame& packet, uint64_t stream_generation, const DeviceStorageSlotTable& slots)
+    {
+        if (!AcceptDataFrame(stream_generation))
+        {
+            return;
+        }
+
+        if (data_frame_user_callback_)
+        {
+            // Convert once for both the storages and the callback
+            api::DataFrameSPtr frame = ProtoToSharedDataFrame(packet, device_data_parts_);
+            for (uint32_t i = 0; i < frame->device_data_count; i++)
+            {
+                const api::TrackingDeviceData& device_data = frame->device_data[i];
+                const DeviceStorageSlot* slot = FindStorageSlot(slots, i, api::Hash(device_data.siu_uuid, device_data.port_id));
+                std::shared_ptr<DeviceDataStorage> storage = slot ? std::atomic_load(&slot->storage) : nullptr;
+                if (storage)
+                {
+                    storage->PushData(device_data);
+                }
+            }
+
+            if (!DispatchDataFrame(frame))
+            {
+                data_frame_user_callback_(*frame);
+            }
+            return;
+        }
 
         for (int i = 0; i < packet.device_data_size(); i++)
         {
-            uint64_t device_hash = api::Hash(packet.device_data(i).siu_uuid(), packet.device_data(i).port_id());
-            auto it = device_data_map_.find(device_hash);
-            if (it != device_data_map_.end())
+            const ommo::TrackingDeviceData& device_data = packet.device_data(i);
+            const DeviceStorageSlot* slot = FindStorageSlot(slots, i, api::Hash(device_data.siu_uuid(), device_data.port_id()));
+
+            std::shared_ptr<DeviceDataStorage> storage = slot ? std::atomic_load(&slot->storage) : nullptr;
+            if (storage)
             {
-                it->second->PushData(packet.device_data(i));
+                storage->PushData(device_data);
             }
         }
+    }
 
+    void DataManager::UpdateDataFrame(const uint8_t* data, size_t size, uint64_t stream_generation, const DeviceStorageSlotTable& slots)
+    {
         if (data_frame_user_callback_)
         {
-            // convert to api UPtr type to be automaitcally destroyed after callback
-            api::DataFrameUPtr cb_packet = ProtoToDataFrame(packet);
-            data_frame_user_callback_(*cb_packet);
+            // The callback needs the message anyway, parse it once and take the regular path
+            thread_local ommo::DataFrame packet;
+            if (!packet.ParseFromArray(data, static_cast<int>(size)))
+            {
+                OMMOLOG_WARN("Dropping malformed DataFrame.");
+                return;
+            }
+            UpdateDataFrame(packet, stream_generation, slots);
+            return;
+        }
+
+        if (!AcceptDataFrame(stream_generation))
+        {
+            return;
+        }
+
+        size_t position = 0;
+        const bool valid = ForEachEncodedDataFrameDevice(data, size,
+            [this, &slots, &position](const uint8_t* device_data, size_t device_data_size)
+            {
+                EncodedDeviceDataLayout layout;
+                if (!ScanEncodedDeviceData(device_data, device_data_size, layout, device_data_parts_))
+                {
+                    position++;
+                    return;
+                }
+                const DeviceStorageSlot* slot = FindStorageSlot(slots, position++, api::Hash(layout.siu_uuid, layout.port_id));
+                std::shared_ptr<DeviceDataStorage> storage = slot ? std::atomic_load(&slot->storage) : nullptr;
+                if (storage)
+                {
+                    storage->PushEncodedData(device_data, device_data_size, layout);
+                }
+            });
+        if (!valid)
+        {
+            OMMOLOG_WARN("Dropping the rest of a malformed DataFrame.");
         }
     }
 
@@ -192,6 +378,144 @@ namespace ommo
         data_frame_user_callback_ = nullptr;
     }
 
+    void DataManager::EnableCallbackDispatch(uint32_t queue_capacity)
+    {
+        if (queue_capacity == 0)
+        {
+            OMMOLOG_WARN("Cannot enable callback dispatch with a queue capacity of 0.");
+            return;
+        }
+
+        // Stop any running dispatcher before the lanes it uses are replaced
+        DisableCallbackDispatch();
+
+        std::unique_lock<std::shared_mutex> lk(dispatch_mtx_);
+        if (stream_type_ == api::DataStreamType::kDeviceData)
+        {
+            device_data_dispatcher_ = std::make_unique<DeviceDataDispatcher>(
+                [this](api::TrackingDeviceDataSPtr& packet)
+                {
+                    if (device_data_user_callback_)
+                    {
+                        device_data_user_callback_(*packet);
+                    }
+                    packet.reset();
+                },
+                queue_capacity);
+        }
+        else if (stream_type_ == api::DataStreamType::kDataFrame)
+        {
+            data_frame_dispatcher_ = std::make_unique<DataFrameDispatcher>(
+                [this](api::DataFrameSPtr& packet)
+                {
+                    if (data_frame_user_callback_)
+                    {
+                        data_frame_user_callback_(*packet);
+                    }
+                    packet.reset();
+                },
+                queue_capacity);
+            data_frame_lane_ = data_frame_dispatcher_->AddLane();
+        }
+        OMMOLOG_INFO("Callback dispatch enabled with queue capacity {}", queue_capacity);
+    }
+
+    void DataManager::DisableCallbackDispatch()
+    {
+        std::unique_ptr<DeviceDataDispatcher> device_data_dispatcher;
+        std::unique_ptr<DataFrameDispatcher> data_frame_dispatcher;
+        {
+            std::unique_lock<std::shared_mutex> lk(dispatch_mtx_);
+            device_data_lanes_.clear();
+            data_frame_lane_.reset();
+            device_data_dispatcher = std::move(device_data_dispatcher_);
+            data_frame_dispatcher = std::move(data_frame_dispatcher_);
+        }
+        // The executor threads are joined here, outside of the lock, so producers are not blocked on a running callback
+    }
+
+    bool DataManager::IsCallbackDispatchEnabled()
+    {
+        std::shared_lock<std::shared_mutex> lk(dispatch_mtx_);
+        return device_data_dispatcher_ || data_frame_dispatcher_;
+    }
+
+    size_t DataManager::GetCallbackQueueDepth()
+    {
+        std::shared_lock<std::shared_mutex> lk(dispatch_mtx_);
+        if (device_data_dispatcher_)
+        {
+            return device_data_dispatcher_->GetQueueDepth();
+        }
+        if (data_frame_dispatcher_)
+        {
+            return data_frame_dispatcher_->GetQueueDepth();
+        }
+        return 0;
+    }
+
+    uint64_t DataManager::GetDroppedCallbackCount()
+    {
+        std::shared_lock<std::shared_mutex> lk(dispatch_mtx_);
+        if (device_data_dispatcher_)
+        {
+            return device_data_dispatcher_->GetDroppedCount();
+        }
+        if (data_frame_dispatcher_)
+        {
+            return data_frame_dispatcher_->GetDroppedCount();
+        }
+        return 0;
+    }
+
+    bool DataManager::DispatchDeviceData(const api::TrackingDeviceDataSPtr& packet)
+    {
+        uint64_t device_hash = api::Hash(packet->siu_uuid, packet->port_id);
+
+        std::shared_lock<std::shared_mutex> lk(dispatch_mtx_);
+        if (!device_data_dispatcher_)
+        {
+            return false;
+        }
+
+        auto lane = device_data_lanes_.find(device_hash);
+        if (lane == device_data_lanes_.end())
+        {
+            // First packet of this device, create its lane
+            lk.unlock();
+            std::unique_lock<std::shared_mutex> unique_lk(dispatch_mtx_);
+            if (!device_data_dispatcher_)
+            {
+                return false;
+            }
+            if (device_data_lanes_.find(device_hash) == device_data_lanes_.end())
+            {
+                device_data_lanes_.emplace(device_hash, device_data_dispatcher_->AddLane());
+            }
+            unique_lk.unlock();
+            lk.lock();
+            if (!device_data_dispatcher_ || (lane = device_data_lanes_.find(device_hash)) == device_data_lanes_.end())
+            {
+                return false;
+            }
+        }
+
+        device_data_dispatcher_->Dispatch(*lane->second, api::TrackingDeviceDataSPtr(packet));
+        return true;
+    }
+
+    bool DataManager::DispatchDataFrame(const api::DataFrameSPtr& packet)
+    {
+        std::shared_lock<std::shared_mutex> lk(dispatch_mtx_);
+        if (!data_frame_dispatcher_ || !data_frame_lane_)
+        {
+            return false;
+        }
+
+        data_frame_dispatcher_->Dispatch(*data_frame_lane_, api::DataFrameSPtr(packet));
+        return true;
+    }
+
     api::DataResponseUPtr DataManager::GetLatestData(const api::DeviceID& device_id)
     {
         api::DataResponseUPtr result(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
@@ -234,13 +558,139 @@ namespace ommo
         return result;
     }
 
-    bool DataManager::AddDataStream(const api::DeviceID& device_id, rpcClientCallData* call_data)
+    api::DataViewUPtr DataManager::GetLatestDataView(const api::DeviceID& device_id, int32_t num_packets)
+    {
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end() && num_packets > 0)
+        {
+            return storage->second->GetLatestDataView(num_packets);
+        }
+        return api::DataViewUPtr(new api::DataView{ api::DataResponseState::kNoData, nullptr, 0, nullptr, 0, nullptr });
+    }
+
+    api::DataResponseUPtr DataManager::GetDataInTimeRange(const api::DeviceID& device_id, api::TimeBase time_base, uint64_t start_time, uint64_t end_time)
+    {
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end())
+        {
+            return storage->second->GetDataInTimeRange(time_base, start_time, end_time);
+        }
+        return api::DataResponseUPtr(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+    }
+
+    api::DataResponseUPtr DataManager::GetNearestSample(const api::DeviceID& device_id, api::TimeBase time_base, uint64_t time)
+    {
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end())
+        {
+            return storage->second->GetNearestSample(time_base, time);
+        }
+        return api::DataResponseUPtr(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+    }
+
+    api::HistoryViewUPtr DataManager::GetHistoryView(const api::DeviceID& device_id, uint32_t sensor_unit_index, int32_t num_packets)
+    {
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end() && num_packets > 0)
+        {
+            return storage->second->GetHistoryView(sensor_unit_index, num_packets);
+        }
+        api::HistoryViewUPtr view(new api::HistoryView());
+        view->state = api::DataResponseState::kNoData;
+        return view;
+    }
+
+    api::DataResponseState DataManager::GetLatestData(const api::DeviceID& device_id, int32_t count, api::DevicePacketBuffer& buffer)
+    {
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end() && count > 0)
+        {
+            return storage->second->GetLatestData(count, buffer);
+        }
+        return api::DataResponseState::kNoData;
+    }
+
+    api::DataResponseState DataManager::GetDataSinceIndex(const api::DeviceID& device_id, int32_t start_idx, api::DevicePacketBuffer& buffer)
+    {
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end())
+        {
+            return storage->second->GetDataSinceIndex(start_idx, buffer);
+        }
+        return api::DataResponseState::kNoData;
+    }
+
+    api::DataCursor DataManager::GetDataCursor(const api::DeviceID& device_id)
+    {
+        api::DataCursor cursor{ 0, 0, 0 };
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end())
+        {
+            cursor.next_position = storage->second->GetHeadPosition();
+        }
+        return cursor;
+    }
+
+    api::DataResponseUPtr DataManager::ReadNewData(const api::DeviceID& device_id, api::DataCursor& cursor)
+    {
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end())
+        {
+            return storage->second->ReadNewData(cursor);
+        }
+        return api::DataResponseUPtr(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+    }
+
+    api::DataResponseState DataManager::ReadNewData(const api::DeviceID& device_id, api::DataCursor& cursor, api::DevicePacketBuffer& buffer)
+    {
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        uint64_t hash = api::Hash(device_id);
+        // Lock the data map and find the storage for this device
+        std::shared_lock<std::shared_mutex> lk(device_data_map_mtx_);
+        auto storage = device_data_map_.find(hash);
+        if (storage != device_data_map_.end())
+        {
+            return storage->second->ReadNewData(cursor, buffer);
+        }
+        return api::DataResponseState::kNoData;
+    }
+
+    bool DataManager::AddDataStream(const api::DeviceID& device_id, std::shared_ptr<SharedDeviceDataStream> stream)
     {
         std::unique_lock<std::mutex> lk(data_stream_map_mtx_);
         uint64_t hash = api::Hash(device_id);
         if (device_data_streams_.find(hash) == device_data_streams_.end())
         {
-            device_data_streams_[hash] = call_data;
+            device_data_streams_[hash] = std::move(stream);
             return true;
         }
         OMMOLOG_WARN("Failed to add device stream for device siu_uuid={} port_id={}. Call data already exists", device_id.siu_uuid, device_id.port_id);
@@ -277,7 +727,7 @@ namespace ommo
         uint64_t hash = api::Hash(device_id);
         if (device_data_streams_.find(hash) != device_data_streams_.end())
         {
-            device_data_streams_[hash]->CancelCall();
+            device_data_streams_[hash]->RemoveSubscriber(this);
             return true;
         }
         OMMOLOG_WARN("Failed to cancel data stream for device siu_uuid={} port_id={}. Data stream pointer does not exist.", device_id.siu_uuid, device_id.port_id);
@@ -289,7 +739,7 @@ namespace ommo
         std::unique_lock<std::mutex> lk(data_stream_map_mtx_);
         for (auto& [device_hash, stream]: device_data_streams_)
         {
-            stream->CancelCall();
+            stream->RemoveSubscriber(this);
         }
     }
 
@@ -302,24 +752,72 @@ namespace ommo
     bool DataManager::CancelDataFrameStream()
     {
         std::lock_guard<std::mutex> lock(dataframe_stream_mtx_);
-        if (dataframe_stream_)
+        bool cancelled = false;
+        for (rpcClientCallData* stream : { dataframe_stream_, pending_dataframe_stream_ })
         {
-            dataframe_stream_->CancelCall();
-            return true;
+            if (stream)
+            {
+                stream->CancelCall();
+                cancelled = true;
+            }
         }
-        return false;
+        return cancelled;
     }
 
     void DataManager::RemoveDataFrameStream()
     {
         std::lock_guard<std::mutex> lock(dataframe_stream_mtx_);
         dataframe_stream_ = nullptr;
+        dataframe_stream_generation_ = 0;
+        pending_dataframe_stream_ = nullptr;
+        pending_dataframe_stream_generation_ = 0;
+    }
+
+    uint64_t DataManager::BeginDataFrameStream(bool make_before_break)
+    {
+        std::lock_guard<std::mutex> lock(dataframe_stream_mtx_);
+        const uint64_t generation = next_dataframe_stream_generation_++;
+
+        // A newer replacement supersedes a pending one that has not delivered a frame yet
+        if (pending_dataframe_stream_)
+        {
+            pending_dataframe_stream_->CancelCall();
+        }
+        pending_dataframe_stream_ = nullptr;
+        pending_dataframe_stream_generation_ = 0;
+
+        if (make_before_break && dataframe_stream_generation_ != 0)
+        {
+            pending_dataframe_stream_generation_ = generation;
+        }
+        else
+        {
+            if (dataframe_stream_)
+            {
+                dataframe_stream_->CancelCall();
+            }
+            dataframe_stream_ = nullptr;
+            dataframe_stream_generation_ = generation;
+        }
+        return generation;
     }
 
-    void DataManager::SetDataFrameStream(rpcClientCallData* call_data)
+    void DataManager::SetDataFrameStream(rpcClientCallData* call_data, uint64_t generation)
     {
         std::lock_guard<std::mutex> lock(dataframe_stream_mtx_);
-        dataframe_stream_ = call_data;
+        if (generation == dataframe_stream_generation_)
+        {
+            dataframe_stream_ = call_data;
+        }
+        else if (generation == pending_dataframe_stream_generation_)
+        {
+            pending_dataframe_stream_ = call_data;
+        }
+        else if (call_data)
+        {
+            // Superseded by a newer stream before it was stored
+            call_data->CancelCall();
+        }
     }
 
     bool DataManager::RemoveStream(rpcClientCallData* call_data)
@@ -330,14 +828,27 @@ namespace ommo
             dataframe_stream_ = nullptr;
             return true;
         }
+        if (pending_dataframe_stream_ == call_data)
+        {
+            // The replacement ended before delivering a frame, keep the current stream
+            pending_dataframe_stream_ = nullptr;
+            pending_dataframe_stream_generation_ = 0;
+            return true;
+        }
         dataframe_stream_lock.unlock();
 
+        OMMOLOG_WARN("Failed to remove data frame stream. stream pointer does not exists");
+        return false;
+    }
+
+    bool DataManager::RemoveStream(const SharedDeviceDataStream* stream)
+    {
         std::unique_lock<std::mutex> data_stream_map_lock(data_stream_map_mtx_);
-        for (auto it = device_data_streams_.begin(); it != device_data_streams_.end();)
+        for (auto it = device_data_streams_.begin(); it != device_data_streams_.end(); it++)
         {
-            if (it->second == call_data)
+            if (it->second.get() == stream)
             {
-                it = device_data_streams_.erase(it);
+                device_data_streams_.erase(it);
                 return true;
             }
         }
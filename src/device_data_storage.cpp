@@ -7,10 +7,58 @@
 */
 
 #include "device_data_storage.h"
+#include "api_member_blocks.h"
 #include "protobuf_converters.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 #include <spdlog/spdlog.h>
 
+namespace
+{
+    // A packet carries at most one latency timestamp of each ommo::api::TimestampType
+    constexpr uint32_t max_latency_timestamp_count = 4;
+
+    // Estimated encoded size of a packet: the header and latency timestamps plus the raw sample, pose and indicators
+    // of every sensor unit. Only sizes the preallocated slab, larger packets still fit.
+    constexpr uint32_t encoded_header_size = 160;
+    constexpr uint32_t encoded_sensor_unit_size = 128;
+
+    // Latest steady time of the sample latency timestamps of a packet, or 0 if it has none
+    uint64_t SampleTime(const ommo::api::TrackingDeviceData& data)
+    {
+        uint64_t sample_time = 0;
+        for (uint32_t i = 0; i < data.latency_timestamp_count; i++)
+        {
+            if (data.latency_timestamps[i].timestamp_type == ommo::api::TimestampType::kTimestampTypeSample)
+            {
+                sample_time = std::max(sample_time, data.latency_timestamps[i].steady_timestamp_milliseconds);
+            }
+        }
+        return sample_time;
+    }
+
+    // Sequence number of a slot holding the packet at <position>
+    uint64_t CompletedSequence(uint64_t position)
+    {
+        return 2 * position + 2;
+    }
+
+    // Copy up to <capacity> elements into a caller owned array. Returns the number of copied elements.
+    template <typename T>
+    uint32_t CopyArrayInto(T* destination, uint32_t capacity, const T* source, uint32_t count)
+    {
+        const uint32_t copy_count = std::min(count, capacity);
+        if (copy_count > 0)
+        {
+            std::memcpy(destination, source, sizeof(T) * copy_count);
+        }
+        return copy_count;
+    }
+}
+
 namespace ommo
 {
 
@@ -24,40 +72,224 @@ namespace ommo
         return device_->port_id;
     }
 
-    DeviceDataStorage::DeviceDataStorage(const api::DeviceDescriptor& device, uint32_t buffer_size) : buffer_size_(buffer_size), packet_received_num_(0),
+    DeviceDataStorage::DeviceDataStorage(const api::DeviceDescriptor& device, uint32_t buffer_size, bool store_columnar_history, bool convert_on_read,
+        uint32_t device_data_parts) : buffer_size_(std::max<uint32_t>(buffer_size, 1)),
          // Initialize device_ as DevicePacketUPtr for automatic deletion
-         device_(api::CopyDeviceDescriptor(device))
+         device_(api::CopyDeviceDescriptor(device)),
+         device_data_parts_(device_data_parts)
     {
-        // Allocate memory for data buffer and info buffer.
-        packet_buffer1_ = new api::DevicePacket[buffer_size_];
-        packet_buffer2_ = new api::DevicePacket[buffer_size_];
+        // Slots and packets are value initialized so they hold no data until written
+        slots_ = std::make_unique<Slot[]>(buffer_size_);
+        packets_ = std::make_unique<api::DevicePacket[]>(buffer_size_);
+
+        // Every sensor unit reports one raw sample and one pose per packet. Unrequested parts get no space.
+        const bool stores_raw_sensor_data = (device_data_parts_ & kDeviceDataRawSensorData) != 0;
+        const bool stores_buttons = (device_data_parts_ & kDeviceDataButtons) != 0;
+        AssignSlab(raw_sensor_data_slab_, stores_raw_sensor_data ? device.sensor_unit_descriptor_count : 0, &Slot::raw_sensor_data);
+        AssignSlab(pose_slab_, device.sensor_unit_descriptor_count, &Slot::poses);
+        AssignSlab(button_slab_, stores_buttons ? device.button_count : 0, &Slot::buttons);
+        AssignSlab(latency_timestamp_slab_, max_latency_timestamp_count, &Slot::latency_timestamps);
+        ReserveSlotArray(spare_slot_.raw_sensor_data, raw_sensor_data_slab_.capacity, retired_arrays_);
+        ReserveSlotArray(spare_slot_.poses, pose_slab_.capacity, retired_arrays_);
+        ReserveSlotArray(spare_slot_.buttons, button_slab_.capacity, retired_arrays_);
+        ReserveSlotArray(spare_slot_.latency_timestamps, latency_timestamp_slab_.capacity, retired_arrays_);
+
+        device_times_ = std::make_unique<uint64_t[]>(buffer_size_);
+        sample_times_ = std::make_unique<uint64_t[]>(buffer_size_);
+
+        if (store_columnar_history)
+        {
+            history_ = std::make_unique<ColumnarHistory>(buffer_size_, device.sensor_unit_descriptor_count);
+        }
+        else if (convert_on_read)
+        {
+            convert_on_read_ = true;
+            AssignSlab(encoded_slab_, encoded_header_size + encoded_sensor_unit_size * device.sensor_unit_descriptor_count, &Slot::encoded);
+            // Decoded slots start without arrays, they are only allocated for the packets that are read
+            decoded_ = std::make_unique<DecodedSlot[]>(buffer_size_);
+        }
+    }
+
+    template <typename T>
+    void DeviceDataStorage::AssignSlab(Slab<T>& slab, uint32_t capacity, SlotArray<T> Slot::* slot_array)
+    {
+        slab.capacity = capacity;
+        slab.data = std::make_unique<T[]>(static_cast<size_t>(capacity) * buffer_size_);
+        for (uint32_t i = 0; i < buffer_size_; i++)
+        {
+            SlotArray<T>& array = slots_[i].*slot_array;
+            array.data = slab.data.get() + static_cast<size_t>(capacity) * i;
+            array.capacity = capacity;
+        }
+    }
+
+    template <typename T>
+    void DeviceDataStorage::ReserveSlotArray(SlotArray<T>& array, uint32_t required, RetiredArrays& retired_arrays)
+    {
+        if (required <= array.capacity)
+        {
+            return;
+        }
 
-        // Initialize buffer memory so they are not random values
-        for (int i = 0; i < buffer_size_; i++)
+        // The packet is larger than the device descriptor suggested. Move the slot to its own array and
+        // grow at least by half so the number of retired arrays stays small.
+        uint32_t new_capacity = std::max<uint32_t>(required, array.capacity + array.capacity / 2);
+        if (array.overflow)
         {
-            // Initialize the buffers to the default value to ensure there is no bad
-            // data in the buffers. Otherwise, the can be pointing to random locations
-            packet_buffer1_[i] = {};
-            packet_buffer2_[i] = {};
+            retired_arrays.emplace_back(array.overflow.release(), std::default_delete<T[]>());
         }
+        array.overflow = std::make_unique<T[]>(new_capacity);
+        array.data = array.overflow.get();
+        array.capacity = new_capacity;
+    }
+
+    void DeviceDataStorage::PrepareSlot(Slot& slot, uint32_t raw_sensor_data_count, uint32_t pose_count, uint32_t button_count, uint32_t latency_timestamp_count,
+        api::TrackingDeviceData& data)
+    {
+        ReserveSlotArray(slot.raw_sensor_data, raw_sensor_data_count, retired_arrays_);
+        ReserveSlotArray(slot.poses, pose_count, retired_arrays_);
+        ReserveSlotArray(slot.buttons, button_count, retired_arrays_);
+        ReserveSlotArray(slot.latency_timestamps, latency_timestamp_count, retired_arrays_);
+
+        data.raw_sensor_data = slot.raw_sensor_data.data;
+        data.poses = slot.poses.data;
+        data.buttons = slot.buttons.data;
+        data.latency_timestamps = slot.latency_timestamps.data;
+    }
+
+    void DeviceDataStorage::PublishSlotHeader(uint32_t index, const api::TrackingDeviceData& data)
+    {
+        // Views borrow packets_ without validating each packet, so a reader may pair the counts of one packet with
+        // the arrays of an older one. Older arrays of a slot are never smaller than its slab part, so the counts in
+        // packets_ are clamped to that. The full counts stay in the slot for the validated reads.
+        Slot& slot = slots_[index];
+        slot.is_encoded = false;
+        slot.raw_sensor_data_count = data.raw_sensor_data_count;
+        slot.pose_count = data.pose_count;
+        slot.button_count = data.button_count;
+        slot.latency_timestamp_count = data.latency_timestamp_count;
+
+        api::TrackingDeviceData& header = packets_[index].device_data;
+        header = data;
+        header.raw_sensor_data_count = std::min(data.raw_sensor_data_count, raw_sensor_data_slab_.capacity);
+        header.pose_count = std::min(data.pose_count, pose_slab_.capacity);
+        header.button_count = std::min(data.button_count, button_slab_.capacity);
+        header.latency_timestamp_count = std::min(data.latency_timestamp_count, latency_timestamp_slab_.capacity);
+    }
+
+    void DeviceDataStorage::WriteSlot(uint32_t index, const ommo::TrackingDeviceData& packet)
+    {
+        const DeviceDataCounts counts = GetDeviceDataCounts(packet, device_data_parts_);
+        api::TrackingDeviceData data{};
+        PrepareSlot(slots_[index], counts.raw_sensor_data_count, counts.pose_count, counts.button_count, counts.latency_timestamp_count, data);
+        ommo::ProtoToTrackingDeviceData(packet, data, device_data_parts_);
+        PublishSlotHeader(index, data);
+        IndexSlot(index, data);
+    }
+
+    void DeviceDataStorage::WriteSlot(uint32_t index, const api::TrackingDeviceData& packet)
+    {
+        // Copy the header, keeping the member pointers of the slot
+        api::TrackingDeviceData data = packet;
+        PrepareSlot(slots_[index], packet.raw_sensor_data_count, packet.pose_count, packet.button_count, packet.latency_timestamp_count, data);
+        CopyArrayInto(data.raw_sensor_data, packet.raw_sensor_data_count, packet.raw_sensor_data, packet.raw_sensor_data_count);
+        CopyArrayInto(data.poses, packet.pose_count, packet.poses, packet.pose_count);
+        CopyArrayInto(data.buttons, packet.button_count, packet.buttons, packet.button_count);
+        CopyArrayInto(data.latency_timestamps, packet.latency_timestamp_count, packet.latency_timestamps, packet.latency_timestamp_count);
+
+        PublishSlotHeader(index, data);
+        IndexSlot(index, data);
+    }
 
-        // Initialize the read and write buffer info.
-        read_buffer_.packet_buffer_ptr = packet_buffer1_;
-        read_buffer_.data_num.store(0);
-        write_buffer_.packet_buffer_ptr = packet_buffer2_;
-        write_buffer_.data_num.store(0);
+    bool DeviceDataStorage::DecodeSpareSlot(const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout, api::TrackingDeviceData& device_data)
+    {
+        PrepareSlot(spare_slot_, layout.raw_sensor_data_count, layout.pose_count, layout.button_count, layout.latency_timestamp_count, device_data);
+        return ommo::DecodeEncodedDeviceData(data, size, layout, device_data);
     }
 
-    DeviceDataStorage::~DeviceDataStorage()
+    void DeviceDataStorage::WriteSpareSlot(uint32_t index, const api::TrackingDeviceData& device_data)
     {
-        // Delete all dynamically allocated memory
-        for (int i = 0; i < buffer_size_; i++)
+        // The arrays of the replaced packet become the spare ones. Readers still copying that packet fail their
+        // validation, since the slot sequence already changed.
+        Slot& slot = slots_[index];
+        std::swap(slot.raw_sensor_data, spare_slot_.raw_sensor_data);
+        std::swap(slot.poses, spare_slot_.poses);
+        std::swap(slot.buttons, spare_slot_.buttons);
+        std::swap(slot.latency_timestamps, spare_slot_.latency_timestamps);
+
+        PublishSlotHeader(index, device_data);
+        IndexSlot(index, device_data);
+    }
+
+    void DeviceDataStorage::WriteEncodedSlot(uint32_t index, const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout)
+    {
+        Slot& slot = slots_[index];
+        ReserveSlotArray(slot.encoded, static_cast<uint32_t>(size), retired_arrays_);
+        std::memcpy(slot.encoded.data, data, size);
+        slot.encoded_size = static_cast<uint32_t>(size);
+        slot.is_encoded = true;
+
+        // The scan already read the index times, so the packet is indexed without converting it
+        ExtendTimeIndex(index, layout.timestamp, layout.sample_time);
+    }
+
+    void DeviceDataStorage::IndexSlot(uint32_t index, const api::TrackingDeviceData& data)
+    {
+        ExtendTimeIndex(index, data.timestamp, SampleTime(data));
+
+        if (history_)
         {
-            api::DestroyDevicePacketMembers(packet_buffer1_[i]);
-            api::DestroyDevicePacketMembers(packet_buffer2_[i]);
+            history_->WriteRow(index, data);
         }
-        delete[] packet_buffer1_;
-        delete[] packet_buffer2_;
+    }
+
+    void DeviceDataStorage::ExtendTimeIndex(uint32_t index, uint32_t timestamp, uint64_t sample_time)
+    {
+        const uint64_t position = head_.load(std::memory_order_relaxed);
+        const uint32_t device_time_delta = timestamp - static_cast<uint32_t>(last_device_time_);
+        if (position == 0)
+        {
+            // The first packet starts the unwrapped device time at its own timestamp
+            last_device_time_ = timestamp;
+        }
+        else if (device_time_delta < (1u << 31))
+        {
+            // Forward step, possibly across a wrap of the 32 bit timestamp
+            last_device_time_ += device_time_delta;
+        }
+        else
+        {
+            // Backward step, the device reset its clock. Start a new epoch above all earlier device times so the
+            // index keeps increasing, and stop searching the older packets: their timestamps belong to the previous
+            // clock and would be matched against query times of the new one.
+            last_device_time_ = (((last_device_time_ >> 32) + 1) << 32) | timestamp;
+            device_time_epoch_start_.store(position, std::memory_order_relaxed);
+        }
+        last_sample_time_ = std::max(last_sample_time_, sample_time);
+        device_times_[index] = last_device_time_;
+        sample_times_[index] = last_sample_time_;
+    }
+
+    uint64_t DeviceDataStorage::BeginSlotWrite()
+    {
+        const uint64_t position = head_.load(std::memory_order_relaxed);
+        const uint32_t index = static_cast<uint32_t>(position % buffer_size_);
+
+        // Mark the slot as being written before touching its content
+        slots_[index].seq.store(CompletedSequence(position) - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        packets_[index].packet_idx = static_cast<uint32_t>(position);
+        return position;
+    }
+
+    void DeviceDataStorage::FinishSlotWrite(uint64_t position)
+    {
+        Slot& slot = slots_[position % buffer_size_];
+
+        // Publish the slot, then the new head
+        slot.seq.store(CompletedSequence(position), std::memory_order_release);
+        head_.store(position + 1, std::memory_order_release);
     }
 
     bool DeviceDataStorage::PushData(const ommo::TrackingDeviceData& packet)
@@ -67,235 +299,668 @@ namespace ommo
             return false;
         }
 
-        // Save the data.
-        const int32_t write_idx = write_buffer_.data_num;
-        if (write_idx < buffer_size_)
+        const uint64_t position = BeginSlotWrite();
+        WriteSlot(static_cast<uint32_t>(position % buffer_size_), packet);
+        FinishSlotWrite(position);
+        return true;
+    }
+
+    bool DeviceDataStorage::PushData(const api::TrackingDeviceData& packet)
+    {
+        if (packet.siu_uuid != device_->siu_uuid || packet.port_id != device_->port_id)
         {
-            // Important to delete previously allocated packets before copying new one
-            api::DestroyDevicePacketMembers(write_buffer_.packet_buffer_ptr[write_idx]);
-            // Save raw data.
-            write_buffer_.packet_buffer_ptr[write_idx].packet_idx = packet_received_num_++;
-            // Use helper function to ensure memory is properly taken over and deallocated
-            api::MoveUniquePtr(write_buffer_.packet_buffer_ptr[write_idx].device_data, ommo::ProtoToTrackingDeviceData(packet));
+            return false;
+        }
 
-            write_buffer_.data_num++;
+        const uint64_t position = BeginSlotWrite();
+        WriteSlot(static_cast<uint32_t>(position % buffer_size_), packet);
+        FinishSlotWrite(position);
+        return true;
+    }
 
-            if (write_buffer_.data_num == buffer_size_)
-            {
-                // Switch write and read buffers when the write buffer is full.
-                SwitchBufferPointer();
-                // Reset the writer buffer (previous read buffer) to save new data.
-                write_buffer_.data_num.store(0);
-            }
+    bool DeviceDataStorage::PushEncodedData(const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout)
+    {
+        if (layout.siu_uuid != device_->siu_uuid || layout.port_id != device_->port_id)
+        {
+            return false;
+        }
+
+        // Decode before touching the ring, so a malformed packet does not replace the oldest stored one
+        api::TrackingDeviceData device_data{};
+        if (!convert_on_read_ && !DecodeSpareSlot(data, size, layout, device_data))
+        {
+            return false;
+        }
+
+        const uint64_t position = BeginSlotWrite();
+        const uint32_t index = static_cast<uint32_t>(position % buffer_size_);
+        if (convert_on_read_)
+        {
+            WriteEncodedSlot(index, data, size, layout);
         }
         else
         {
-            SwitchBufferPointer();
+            WriteSpareSlot(index, device_data);
+        }
+        FinishSlotWrite(position);
+        return true;
+    }
+
+    bool DeviceDataStorage::PushEncodedData(const uint8_t* data, size_t size)
+    {
+        EncodedDeviceDataLayout layout;
+        return ScanEncodedDeviceData(data, size, layout, device_data_parts_) && PushEncodedData(data, size, layout);
+    }
 
-            // Important to delete previously allocated packets before copying new one
-            api::DestroyDevicePacketMembers(write_buffer_.packet_buffer_ptr[0]);
-            // Save raw data.
-            write_buffer_.packet_buffer_ptr[0].packet_idx = packet_received_num_++;
-            // Use helper function to ensure memory is properly taken over and deallocated
-            api::MoveUniquePtr(write_buffer_.packet_buffer_ptr[0].device_data, ommo::ProtoToTrackingDeviceData(packet));
+    bool DeviceDataStorage::ReadPacketHeader(uint64_t position, uint32_t& packet_idx, api::TrackingDeviceData& header) const
+    {
+        const uint32_t index = static_cast<uint32_t>(position % buffer_size_);
+        const Slot& slot = slots_[index];
+        const uint64_t expected_seq = CompletedSequence(position);
 
-            write_buffer_.data_num.store(1);
+        if (slot.seq.load(std::memory_order_acquire) != expected_seq)
+        {
+            return false;
         }
+
+        // Copy the header first. The counts and array pointers can only be trusted once the sequence is validated,
+        // the arrays they point to are never freed while the storage exists.
+        packet_idx = packets_[index].packet_idx;
+        const bool is_encoded = slot.is_encoded;
+        header = packets_[index].device_data;
+        header.raw_sensor_data_count = slot.raw_sensor_data_count;
+        header.pose_count = slot.pose_count;
+        header.button_count = slot.button_count;
+        header.latency_timestamp_count = slot.latency_timestamp_count;
+        if (!IsPacketStored(position))
+        {
+            return false;
+        }
+        return !is_encoded || ReadDecodedHeader(position, header);
+    }
+
+    bool DeviceDataStorage::ReadDecodedHeader(uint64_t position, api::TrackingDeviceData& header) const
+    {
+        const uint64_t expected_seq = CompletedSequence(position);
+        DecodedSlot& decoded = decoded_[position % buffer_size_];
+
+        // Copy the header under the lock. A reader converting a newer packet into this decoded slot rewrites the
+        // counts and may grow the arrays, so an unlocked copy could pair new counts with old, smaller arrays.
+        std::lock_guard<std::mutex> lock(decode_mtx_);
+        if (decoded.seq.load(std::memory_order_relaxed) != expected_seq && !DecodeSlot(position))
+        {
+            return false;
+        }
+        header = decoded.device_data;
+
+        // The arrays stay allocated once replaced. Their content is only rewritten for a newer packet, after the
+        // writer reused the slot, which the caller detects when validating the slot after copying the members.
         return true;
     }
 
-    api::DataResponseUPtr DeviceDataStorage::GetLatestData()
+    bool DeviceDataStorage::DecodeSlot(uint64_t position) const
     {
-        api::DataResponseUPtr result(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
-        // The write and read buffers cannot switch while reading data.
-        std::shared_lock<std::shared_mutex> lock(switch_mutex_);
+        const uint32_t index = static_cast<uint32_t>(position % buffer_size_);
+        const Slot& slot = slots_[index];
+        DecodedSlot& decoded = decoded_[index];
 
-        // If write_buffer already has data, get the latest data from it.
-        int32_t idx = write_buffer_.data_num - 1;
-        if (idx >= 0)
+        // Copy the encoded packet out of the slot and validate the copy before touching the decoded slot. Once
+        // validated, the writer can only move on to newer packets, so readers of older packets fail their validation.
+        if (slot.seq.load(std::memory_order_acquire) != CompletedSequence(position))
         {
-            result->packets = new api::DevicePacket[1];
-            api::MoveAndDeletePtr(result->packets[0], api::CopyDevicePacket(write_buffer_.packet_buffer_ptr[idx]));
-            result->packet_count = 1;
-            result->state = api::DataResponseState::kSuccess;
+            return false;
         }
-        else
+        // Validate the size and array before copying, like ReadPacketHeader. The writer may grow the slot meanwhile,
+        // pairing a new size with an old, smaller array. A validated pair is safe to copy from, since replaced arrays
+        // are never freed while the storage exists.
+        const uint8_t* encoded = slot.encoded.data;
+        const uint32_t encoded_capacity = slot.encoded.capacity;
+        const uint32_t encoded_size = slot.encoded_size;
+        if (!IsPacketStored(position) || encoded_size > encoded_capacity)
         {
-            idx = read_buffer_.data_num - 1;
-            if (idx >= 0)
-            {
-                result->packets = new api::DevicePacket[1];
-                api::MoveAndDeletePtr(result->packets[0], api::CopyDevicePacket(read_buffer_.packet_buffer_ptr[idx]));
-                result->packet_count = 1;
-                result->state = api::DataResponseState::kSuccess;
-            }
+            return false;
         }
-        // If the read and write buffers are both empty, return default value.
-        return result;
+        decode_buffer_.resize(encoded_size);
+        std::memcpy(decode_buffer_.data(), encoded, encoded_size);
+        if (!IsPacketStored(position))
+        {
+            return false;
+        }
+
+        decoded.seq.store(0, std::memory_order_relaxed);
+        EncodedDeviceDataLayout layout;
+        if (!ScanEncodedDeviceData(decode_buffer_.data(), encoded_size, layout, device_data_parts_))
+        {
+            return false;
+        }
+        ReserveSlotArray(decoded.raw_sensor_data, layout.raw_sensor_data_count, decoded_retired_arrays_);
+        ReserveSlotArray(decoded.poses, layout.pose_count, decoded_retired_arrays_);
+        ReserveSlotArray(decoded.buttons, layout.button_count, decoded_retired_arrays_);
+        ReserveSlotArray(decoded.latency_timestamps, layout.latency_timestamp_count, decoded_retired_arrays_);
+
+        api::TrackingDeviceData& data = decoded.device_data;
+        data.raw_sensor_data = decoded.raw_sensor_data.data;
+        data.poses = decoded.poses.data;
+        data.buttons = decoded.buttons.data;
+        data.latency_timestamps = decoded.latency_timestamps.data;
+        if (!DecodeEncodedDeviceData(decode_buffer_.data(), encoded_size, layout, data))
+        {
+            return false;
+        }
+
+        decoded.seq.store(CompletedSequence(position), std::memory_order_release);
+        return true;
     }
 
-    api::DataResponseUPtr DeviceDataStorage::GetLatestData(uint32_t request_count)
+    bool DeviceDataStorage::IsPacketStored(uint64_t position) const
     {
-        api::DataResponseUPtr result(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slots_[position % buffer_size_].seq.load(std::memory_order_relaxed) == CompletedSequence(position);
+    }
 
-        // The write and read buffers cannot switch while reading data.
-        std::shared_lock<std::shared_mutex> lock(switch_mutex_);
+    bool DeviceDataStorage::ReadPacket(uint64_t position, api::DevicePacket& packet) const
+    {
+        uint32_t packet_idx;
+        api::TrackingDeviceData header;
+        if (!ReadPacketHeader(position, packet_idx, header))
+        {
+            return false;
+        }
 
-        const int32_t write_packet_num = write_buffer_.data_num;
-        const int32_t read_packet_num = read_buffer_.data_num;
+        // Copy the member arrays into one block owned by the caller
+        PooledArrayBlock block;
+        ReserveTrackingDeviceDataMembers(block, header.raw_sensor_data_count, header.pose_count, header.button_count, header.latency_timestamp_count);
+        block.Allocate();
+
+        packet.packet_idx = packet_idx;
+        packet.device_data = header;
+        api::TrackingDeviceData& data = packet.device_data;
+        PlaceTrackingDeviceDataMembers(block, data, header.raw_sensor_data_count, header.pose_count, header.button_count, header.latency_timestamp_count);
+        CopyArrayInto(data.raw_sensor_data, header.raw_sensor_data_count, header.raw_sensor_data, header.raw_sensor_data_count);
+        CopyArrayInto(data.poses, header.pose_count, header.poses, header.pose_count);
+        CopyArrayInto(data.buttons, header.button_count, header.buttons, header.button_count);
+        CopyArrayInto(data.latency_timestamps, header.latency_timestamp_count, header.latency_timestamps, header.latency_timestamp_count);
+
+        // Validate again, the writer may have reused the slot while the arrays were copied
+        if (!IsPacketStored(position))
+        {
+            api::DestroyDevicePacketMembers(packet);
+            return false;
+        }
+        return true;
+    }
 
-        // Only get data if request_count is not 0
-        if (request_count > 0)
+    bool DeviceDataStorage::ReadPacket(uint64_t position, api::DevicePacket& packet, const api::DevicePacketBuffer& buffer, bool& truncated) const
+    {
+        uint32_t packet_idx;
+        api::TrackingDeviceData header;
+        if (!ReadPacketHeader(position, packet_idx, header))
         {
-            if (request_count <= write_packet_num)
-            {
-                // Read from write buffer.
-                uint32_t start_idx = write_packet_num - request_count;
-                result->packets = new api::DevicePacket[request_count];
-
-                for (int32_t i = 0; i < request_count; i++)
-                {
-                    // Create new copy and take over memory owernship of copy
-                    api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(write_buffer_.packet_buffer_ptr[start_idx + i]));
-                }
-                result->packet_count = request_count;
-                result->state = api::DataResponseState::kSuccess;
-            }
-            else if (request_count <= read_packet_num + write_packet_num)
+            return false;
+        }
+
+        // Keep the caller's member arrays and copy the members into them
+        api::TrackingDeviceData& data = packet.device_data;
+        api::RawSensorData* raw_sensor_data = data.raw_sensor_data;
+        api::PoseData* poses = data.poses;
+        api::ButtonState* buttons = data.buttons;
+        api::TimestampData* latency_timestamps = data.latency_timestamps;
+
+        packet.packet_idx = packet_idx;
+        data = header;
+        data.raw_sensor_data = raw_sensor_data;
+        data.poses = poses;
+        data.buttons = buttons;
+        data.latency_timestamps = latency_timestamps;
+        data.raw_sensor_data_count = CopyArrayInto(raw_sensor_data, buffer.raw_sensor_data_capacity, header.raw_sensor_data, header.raw_sensor_data_count);
+        data.pose_count = CopyArrayInto(poses, buffer.pose_capacity, header.poses, header.pose_count);
+        data.button_count = CopyArrayInto(buttons, buffer.button_capacity, header.buttons, header.button_count);
+        data.latency_timestamp_count = CopyArrayInto(latency_timestamps, buffer.latency_timestamp_capacity, header.latency_timestamps, header.latency_timestamp_count);
+        truncated = data.raw_sensor_data_count < header.raw_sensor_data_count || data.pose_count < header.pose_count ||
+            data.button_count < header.button_count || data.latency_timestamp_count < header.latency_timestamp_count;
+
+        // Validate again, the writer may have reused the slot while the arrays were copied.
+        // Nothing to clean up on failure, the packet is overwritten by the next read.
+        return IsPacketStored(position);
+    }
+
+    api::DataResponseUPtr DeviceDataStorage::ReadPackets(uint64_t first, uint64_t end) const
+    {
+        api::DataResponseUPtr result(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+        if (end <= first)
+        {
+            return result;
+        }
+
+        result->packets = NewZeroedPooledArray<api::DevicePacket>(end - first);
+        for (uint64_t position = first; position < end; position++)
+        {
+            // Packets are read oldest first, so a packet that fails to read was overwritten and is left out
+            if (ReadPacket(position, result->packets[result->packet_count]))
             {
-                int32_t idx = read_packet_num + write_packet_num - request_count;
-                result->packets = new api::DevicePacket[request_count];
-
-                // First read from the read buffer.
-                // Note: variable i is used when getting data from read buffer and write buffer.
-                int32_t i = 0;
-                for (; idx < read_packet_num; idx++)
-                {
-                    // Create new copy and take over memory owernship of copy
-                    api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(read_buffer_.packet_buffer_ptr[idx]));
-                    i++;
-                }
-                // Then read from write buffer.
-                for (idx = 0; idx < write_packet_num; idx++)
-                {
-                    api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(write_buffer_.packet_buffer_ptr[idx]));
-                    i++;
-                }
-                result->packet_count = request_count;
-                result->state = api::DataResponseState::kSuccess;
+                result->packet_count++;
             }
-            else if (read_packet_num + write_packet_num > 0)
+        }
+
+        if (result->packet_count > 0)
+        {
+            result->state = result->packet_count == end - first ? api::DataResponseState::kSuccess : api::DataResponseState::kPartialData;
+        }
+        return result;
+    }
+
+    api::DataResponseState DeviceDataStorage::ReadPackets(uint64_t first, uint64_t end, api::DevicePacketBuffer& buffer) const
+    {
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        for (uint64_t position = first; position < end; position++)
+        {
+            bool truncated = false;
+            if (ReadPacket(position, buffer.packets[buffer.packet_count], buffer, truncated))
             {
-                result->packets = new api::DevicePacket[read_packet_num + write_packet_num];
-                // First read from read buffer.
-                // Note: variable i is used when getting data from read buffer and write buffer.
-                int32_t i = 0;
-                for (int32_t idx = 0; idx < read_packet_num; idx++)
-                {
-                    api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(read_buffer_.packet_buffer_ptr[idx]));
-                    i++;
-                }
-                // Then read from write buffer.
-                for (int32_t idx = 0; idx < write_packet_num; idx++)
-                {
-                    api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(write_buffer_.packet_buffer_ptr[idx]));
-                    i++;
-                }
-                result->packet_count = read_packet_num + write_packet_num;
-                result->state = api::DataResponseState::kPartialData;
+                buffer.packet_count++;
+                buffer.truncated_packet_count += truncated ? 1 : 0;
             }
         }
-        return result;
+
+        if (buffer.packet_count == 0)
+        {
+            return api::DataResponseState::kNoData;
+        }
+        return buffer.packet_count == end - first ? api::DataResponseState::kSuccess : api::DataResponseState::kPartialData;
     }
 
-    api::DataResponseUPtr DeviceDataStorage::GetDataSinceIndex(uint32_t start_idx)
+    bool DeviceDataStorage::FindPositionSinceIndex(uint64_t head, uint32_t start_idx, uint64_t& first, bool& complete) const
     {
-        api::DataResponseUPtr result(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+        if (head == 0)
+        {
+            return false;
+        }
 
-        // The write and read buffers cannot switch while reading data.
-        std::shared_lock<std::shared_mutex> lock(switch_mutex_);
+        // Distance from start_idx back to the latest packet, taking wrapping of packet_idx into account
+        const uint64_t latest = head - 1;
+        const uint32_t distance = static_cast<uint32_t>(latest) - start_idx;
+        if (distance >= (1u << 31))
+        {
+            // start_idx is newer than the latest packet
+            return false;
+        }
 
-        const int32_t write_packet_num = write_buffer_.data_num;
-        const int32_t read_packet_num = read_buffer_.data_num;
+        const uint64_t oldest = head - std::min<uint64_t>(head, buffer_size_);
+        complete = distance <= latest && latest - distance >= oldest;
+        first = complete ? latest - distance : oldest;
+        return true;
+    }
 
-        // First check the write buffer.
-        if (write_packet_num > 0 && write_buffer_.packet_buffer_ptr[write_packet_num - 1].packet_idx < start_idx)
+    bool DeviceDataStorage::ReadIndexTime(uint64_t position, api::TimeBase time_base, uint64_t& time) const
+    {
+        const uint32_t index = static_cast<uint32_t>(position % buffer_size_);
+        if (slots_[index].seq.load(std::memory_order_acquire) != CompletedSequence(position))
         {
-            return result;
+            return false;
         }
-        // If the first packet in write buffer has index <= start_idx, it contains all of the required packets.
-        else if (write_packet_num > 0 && write_buffer_.packet_buffer_ptr[0].packet_idx <= start_idx)
+        time = time_base == api::TimeBase::kTimeBaseDeviceTimestamp ? device_times_[index] : sample_times_[index];
+        return IsPacketStored(position);
+    }
+
+    uint64_t DeviceDataStorage::ToIndexTime(api::TimeBase time_base, uint64_t time, uint64_t head) const
+    {
+        if (time_base != api::TimeBase::kTimeBaseDeviceTimestamp || head == 0)
         {
-            int32_t idx = start_idx - write_buffer_.packet_buffer_ptr[0].packet_idx;
-            uint32_t packet_count = write_packet_num - idx;
-            result->packets = new api::DevicePacket[packet_count];
+            return time;
+        }
 
-            for (int32_t i = 0; i < packet_count; i++)
-            {
-                api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(write_buffer_.packet_buffer_ptr[idx + i]));
-            }
-            result->state = api::DataResponseState::kSuccess;
-            result->packet_count = packet_count;
+        uint64_t latest_time = 0;
+        while (!ReadIndexTime(head - 1, time_base, latest_time))
+        {
+            head = head_.load(std::memory_order_acquire);
         }
-        // If write buffer is empty and the latest packet in read buffer has index < start_idx, requested data is not available.
-        else if (write_packet_num == 0 && read_packet_num > 0 && read_buffer_.packet_buffer_ptr[read_packet_num - 1].packet_idx < start_idx)
+
+        // Same rule as packet_idx: timestamps up to 2^31 before the latest one are in the past, others in the future
+        const uint32_t distance = static_cast<uint32_t>(latest_time) - static_cast<uint32_t>(time);
+        if (distance < (1u << 31))
         {
-            return result;
+            return distance > latest_time ? 0 : latest_time - distance;
         }
-        // If the first packet in read buffer has index <= start_idx, packets will be required from both the read and write buffers
-        else if (read_packet_num > 0 && read_buffer_.packet_buffer_ptr[0].packet_idx <= start_idx)
+        return latest_time + static_cast<uint32_t>(static_cast<uint32_t>(time) - static_cast<uint32_t>(latest_time));
+    }
+
+    uint64_t DeviceDataStorage::OldestSearchedPosition(api::TimeBase time_base, uint64_t head) const
+    {
+        const uint64_t oldest = head - std::min<uint64_t>(head, buffer_size_);
+        if (time_base != api::TimeBase::kTimeBaseDeviceTimestamp)
         {
-            int32_t idx = start_idx - read_buffer_.packet_buffer_ptr[0].packet_idx;
-            result->packets = new api::DevicePacket[read_packet_num - idx + write_packet_num];
+            return oldest;
+        }
+        return std::max(oldest, device_time_epoch_start_.load(std::memory_order_relaxed));
+    }
 
-            // Note: variable i is used when getting data from read buffer and write buffer.
-            int32_t i = 0;
-            for (; idx < read_packet_num; idx++)
+    uint64_t DeviceDataStorage::LowerBoundTime(api::TimeBase time_base, uint64_t time, uint64_t first, uint64_t end) const
+    {
+        while (first < end)
+        {
+            const uint64_t middle = first + (end - first) / 2;
+            uint64_t middle_time = 0;
+            if (!ReadIndexTime(middle, time_base, middle_time) || middle_time < time)
             {
-                api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(read_buffer_.packet_buffer_ptr[idx]));
-                i++;
+                first = middle + 1;
             }
-            for (idx = 0; idx < write_packet_num; idx++)
+            else
             {
-                api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(write_buffer_.packet_buffer_ptr[idx]));
-                i++;
+                end = middle;
             }
+        }
+        return first;
+    }
+
+    api::DataResponseUPtr DeviceDataStorage::GetDataInTimeRange(api::TimeBase time_base, uint64_t start_time, uint64_t end_time) const
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t oldest = head - std::min<uint64_t>(head, buffer_size_);
+        const uint64_t searched = OldestSearchedPosition(time_base, head);
+        const uint64_t start = ToIndexTime(time_base, start_time, head);
+        const uint64_t end = ToIndexTime(time_base, end_time, head);
+        if (head == 0 || end < start)
+        {
+            return api::DataResponseUPtr(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+        }
+
+        const uint64_t first = LowerBoundTime(time_base, start, searched, head);
+        const uint64_t last = end == UINT64_MAX ? head : LowerBoundTime(time_base, end + 1, first, head);
+        api::DataResponseUPtr result = ReadPackets(first, last);
+
+        // Packets before the start of the range may already have been overwritten
+        uint64_t oldest_time = 0;
+        const bool range_overwritten = first == oldest && oldest > 0 && (!ReadIndexTime(oldest, time_base, oldest_time) || oldest_time > start);
+        if (result->state == api::DataResponseState::kSuccess && range_overwritten)
+        {
+            result->state = api::DataResponseState::kPartialData;
+        }
+        return result;
+    }
+
+    api::DataResponseUPtr DeviceDataStorage::GetNearestSample(api::TimeBase time_base, uint64_t time) const
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t oldest = OldestSearchedPosition(time_base, head);
+        const uint64_t target = ToIndexTime(time_base, time, head);
+
+        // The nearest packet is either the first one at or after the target or the one before it
+        uint64_t nearest = LowerBoundTime(time_base, target, oldest, head);
+        uint64_t after_time = 0;
+        uint64_t before_time = 0;
+        const bool after_valid = nearest < head && ReadIndexTime(nearest, time_base, after_time);
+        const bool before_valid = nearest > oldest && ReadIndexTime(nearest - 1, time_base, before_time);
+        if (before_valid && (!after_valid || target - before_time <= after_time - target))
+        {
+            nearest--;
+        }
+        else if (!after_valid)
+        {
+            return api::DataResponseUPtr(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+        }
+        return ReadPackets(nearest, nearest + 1);
+    }
+
+    api::DataResponseUPtr DeviceDataStorage::GetLatestData()
+    {
+        api::DataResponseUPtr result(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+
+        api::DevicePacket packet{};
+        uint64_t head = head_.load(std::memory_order_acquire);
+        // Retry with the new head if the writer overwrote the latest packet while it was being copied
+        while (head > 0 && !ReadPacket(head - 1, packet))
+        {
+            head = head_.load(std::memory_order_acquire);
+        }
+
+        if (head > 0)
+        {
+            result->packets = NewPooledArray<api::DevicePacket>(1);
+            result->packets[0] = packet;
+            result->packet_count = 1;
             result->state = api::DataResponseState::kSuccess;
-            result->packet_count = read_packet_num + write_packet_num + read_buffer_.packet_buffer_ptr[0].packet_idx - start_idx;
         }
-        else if (read_packet_num > 0 && read_buffer_.packet_buffer_ptr[0].packet_idx > start_idx)
+        // If the storage is empty, return default value.
+        return result;
+    }
+
+    api::DataResponseUPtr DeviceDataStorage::GetLatestData(uint32_t request_count)
+    {
+        // Only get data if request_count is not 0
+        if (request_count == 0)
+        {
+            return api::DataResponseUPtr(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+        }
+
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t available = std::min<uint64_t>(head, buffer_size_);
+        const uint64_t count = std::min<uint64_t>(request_count, available);
+
+        api::DataResponseUPtr result = ReadPackets(head - count, head);
+        if (result->state == api::DataResponseState::kSuccess && result->packet_count < request_count)
+        {
+            result->state = api::DataResponseState::kPartialData;
+        }
+        return result;
+    }
+
+    api::DataResponseUPtr DeviceDataStorage::GetDataSinceIndex(uint32_t start_idx)
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t first;
+        bool complete;
+        if (!FindPositionSinceIndex(head, start_idx, first, complete))
+        {
+            return api::DataResponseUPtr(new api::DataResponse{ api::DataResponseState::kNoData, nullptr, 0 });
+        }
+
+        // If part of the requested packets were already overwritten, return all that are available
+        api::DataResponseUPtr result = ReadPackets(first, head);
+        if (!complete && result->state == api::DataResponseState::kSuccess)
+        {
+            result->state = api::DataResponseState::kPartialData;
+        }
+        return result;
+    }
+
+    api::DataResponseState DeviceDataStorage::GetLatestData(uint32_t request_count, api::DevicePacketBuffer& buffer)
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t available = std::min<uint64_t>(head, buffer_size_);
+        const uint64_t count = std::min<uint64_t>({ request_count, available, buffer.packet_capacity });
+
+        api::DataResponseState state = ReadPackets(head - count, head, buffer);
+        if (state == api::DataResponseState::kSuccess && buffer.packet_count < request_count)
+        {
+            state = api::DataResponseState::kPartialData;
+        }
+        return state;
+    }
+
+    api::DataResponseState DeviceDataStorage::GetDataSinceIndex(uint32_t start_idx, api::DevicePacketBuffer& buffer)
+    {
+        buffer.packet_count = 0;
+        buffer.truncated_packet_count = 0;
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t first;
+        bool complete;
+        if (!FindPositionSinceIndex(head, start_idx, first, complete))
+        {
+            return api::DataResponseState::kNoData;
+        }
+
+        // Keep the oldest packets if the buffer is too small so the caller can continue from the last one
+        const uint64_t end = std::min<uint64_t>(head, first + buffer.packet_capacity);
+        api::DataResponseState state = ReadPackets(first, end, buffer);
+        if (state == api::DataResponseState::kSuccess && (!complete || end < head))
+        {
+            state = api::DataResponseState::kPartialData;
+        }
+        return state;
+    }
+
+    uint64_t DeviceDataStorage::GetHeadPosition() const
+    {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    uint64_t DeviceDataStorage::StartCursorRead(api::DataCursor& cursor, uint64_t head) const
+    {
+        cursor.lost_packet_count = 0;
+
+        // A cursor ahead of the head was created for an earlier storage of the device, start over
+        if (cursor.next_position > head)
+        {
+            cursor.next_position = 0;
+        }
+
+        const uint64_t oldest = head - std::min<uint64_t>(head, buffer_size_);
+        if (cursor.next_position < oldest)
+        {
+            cursor.lost_packet_count = oldest - cursor.next_position;
+            return oldest;
+        }
+        return cursor.next_position;
+    }
+
+    void DeviceDataStorage::FinishCursorRead(api::DataCursor& cursor, uint64_t first, uint64_t end, uint32_t read_count) const
+    {
+        // Packets overwritten while being copied are lost as well
+        cursor.lost_packet_count += (end - first) - read_count;
+        cursor.total_lost_packet_count += cursor.lost_packet_count;
+        cursor.next_position = end;
+    }
+
+    api::DataResponseUPtr DeviceDataStorage::ReadNewData(api::DataCursor& cursor) const
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t first = StartCursorRead(cursor, head);
+
+        api::DataResponseUPtr result = ReadPackets(first, head);
+        FinishCursorRead(cursor, first, head, result->packet_count);
+        if (result->state == api::DataResponseState::kSuccess && cursor.lost_packet_count > 0)
         {
-            result->packets = new api::DevicePacket[read_packet_num + write_packet_num];
-            int32_t i = 0;
-            // First read from read buffer.
-            for (int32_t idx = 0; idx < read_packet_num; idx++)
-            {
-                api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(read_buffer_.packet_buffer_ptr[idx]));
-                i++;
-            }
-            // Then read from write buffer.
-            for (int32_t idx = 0; idx < write_packet_num; idx++)
-            {
-                api::MoveAndDeletePtr(result->packets[i], api::CopyDevicePacket(write_buffer_.packet_buffer_ptr[idx]));
-                i++;
-            }
             result->state = api::DataResponseState::kPartialData;
-            result->packet_count = write_packet_num + read_packet_num;
         }
         return result;
     }
 
-    void DeviceDataStorage::SwitchBufferPointer()
+    api::DataResponseState DeviceDataStorage::ReadNewData(api::DataCursor& cursor, api::DevicePacketBuffer& buffer) const
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t first = StartCursorRead(cursor, head);
+        const uint64_t end = std::min<uint64_t>(head, first + buffer.packet_capacity);
+
+        api::DataResponseState state = ReadPackets(first, end, buffer);
+        FinishCursorRead(cursor, first, end, buffer.packet_count);
+        if (state == api::DataResponseState::kSuccess && (cursor.lost_packet_count > 0 || end < head))
+        {
+            state = api::DataResponseState::kPartialData;
+        }
+        return state;
+    }
+
+    DeviceDataStorage::ViewWindow DeviceDataStorage::GetLatestViewWindow(uint32_t count) const
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        // Leave out the oldest slot, it is the next one the writer overwrites
+        const uint64_t max_count = buffer_size_ > 1 ? buffer_size_ - 1 : 1;
+
+        ViewWindow window{};
+        window.count = std::min<uint64_t>({ count, head, max_count });
+        window.first_position = head - window.count;
+        window.first_index = static_cast<uint32_t>(window.first_position % buffer_size_);
+        window.first_count = static_cast<uint32_t>(std::min<uint64_t>(window.count, buffer_size_ - window.first_index));
+        window.wrapped_count = static_cast<uint32_t>(window.count - window.first_count);
+        return window;
+    }
+
+    api::DataViewUPtr DeviceDataStorage::GetLatestDataView(uint32_t count) const
     {
-        std::unique_lock<std::shared_mutex> lock(switch_mutex_);
+        const ViewWindow window = GetLatestViewWindow(count);
 
-        api::DevicePacket* temp_ptr = write_buffer_.packet_buffer_ptr;
-        write_buffer_.packet_buffer_ptr = read_buffer_.packet_buffer_ptr;
-        read_buffer_.packet_buffer_ptr = temp_ptr;
+        api::DataViewUPtr view(new api::DataView{ api::DataResponseState::kNoData, nullptr, 0, nullptr, 0, nullptr });
+        view->guard = new DataViewGuard{ shared_from_this(), window.first_position, window.count };
+        if (window.count == 0 || convert_on_read_)
+        {
+            return view;
+        }
+
+        view->packets = &packets_[window.first_index];
+        view->packet_count = window.first_count;
+        if (window.wrapped_count > 0)
+        {
+            view->wrapped_packets = &packets_[0];
+            view->wrapped_packet_count = window.wrapped_count;
+        }
+        view->state = window.count == count ? api::DataResponseState::kSuccess : api::DataResponseState::kPartialData;
+        return view;
+    }
+
+    api::HistoryViewUPtr DeviceDataStorage::GetHistoryView(uint32_t sensor_unit_index, uint32_t count) const
+    {
+        api::HistoryViewUPtr view(new api::HistoryView());
+        view->state = api::DataResponseState::kNoData;
+        if (history_ == nullptr || sensor_unit_index >= history_->GetSensorUnitCount())
+        {
+            return view;
+        }
+
+        const ViewWindow window = GetLatestViewWindow(count);
+        view->guard = new DataViewGuard{ shared_from_this(), window.first_position, window.count };
+        if (window.count == 0)
+        {
+            return view;
+        }
+
+        auto make_span = [&window](auto* column, auto& span)
+        {
+            span.data = column + window.first_index;
+            span.count = window.first_count;
+            span.wrapped_data = window.wrapped_count > 0 ? column : nullptr;
+            span.wrapped_count = window.wrapped_count;
+        };
+        using FloatColumn = ColumnarHistory::FloatColumn;
+        using IntColumn = ColumnarHistory::IntColumn;
+        const ColumnarHistory& history = *history_;
+        const uint32_t unit = sensor_unit_index;
+
+        make_span(history.GetTimestamps(), view->timestamps);
+        make_span(history.GetColumn(FloatColumn::kPositionX, unit), view->position_x);
+        make_span(history.GetColumn(FloatColumn::kPositionY, unit), view->position_y);
+        make_span(history.GetColumn(FloatColumn::kPositionZ, unit), view->position_z);
+        make_span(history.GetColumn(FloatColumn::kQuaternionW, unit), view->quaternion_w);
+        make_span(history.GetColumn(FloatColumn::kQuaternionX, unit), view->quaternion_x);
+        make_span(history.GetColumn(FloatColumn::kQuaternionY, unit), view->quaternion_y);
+        make_span(history.GetColumn(FloatColumn::kQuaternionZ, unit), view->quaternion_z);
+        make_span(history.GetColumn(FloatColumn::kIndicatorValue, unit), view->indicator_value);
+        make_span(history.GetColumn(FloatColumn::kMotionIndicator, unit), view->motion_indicator);
+        make_span(history.GetColumn(FloatColumn::kBadDataIndicator, unit), view->bad_data_indicator);
+        make_span(history.GetColumn(IntColumn::kAccelX, unit), view->accel_x);
+        make_span(history.GetColumn(IntColumn::kAccelY, unit), view->accel_y);
+        make_span(history.GetColumn(IntColumn::kAccelZ, unit), view->accel_z);
+        make_span(history.GetColumn(IntColumn::kGyroX, unit), view->gyro_x);
+        make_span(history.GetColumn(IntColumn::kGyroY, unit), view->gyro_y);
+        make_span(history.GetColumn(IntColumn::kGyroZ, unit), view->gyro_z);
+        make_span(history.GetColumn(IntColumn::kMagX, unit), view->mag_x);
+        make_span(history.GetColumn(IntColumn::kMagY, unit), view->mag_y);
+        make_span(history.GetColumn(IntColumn::kMagZ, unit), view->mag_z);
+
+        view->state = window.count == count ? api::DataResponseState::kSuccess : api::DataResponseState::kPartialData;
+        return view;
+    }
+
+    bool DeviceDataStorage::IsViewValid(uint64_t first_position, uint64_t count) const
+    {
+        if (count == 0)
+        {
+            return true;
+        }
 
-        const int read_num = read_buffer_.data_num;
-        const int write_num = write_buffer_.data_num.exchange(read_num);
-        read_buffer_.data_num.store(write_num);
+        // The writer overwrites the oldest packet first and marks its slot before writing any newer one,
+        // so the viewed packets are intact as long as the slot of the oldest one is unchanged.
+        return IsPacketStored(first_position);
     }
 
 }  // namespace ommo
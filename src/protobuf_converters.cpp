@@ -7,6 +7,163 @@
 */
 
 #include "protobuf_converters.h"
+#include "api_member_blocks.h"
+
+namespace
+{
+    using ommo::PooledArrayBlock;
+
+    // Every struct owns one block for its own member arrays, so the Destroy*Members function of a nested or embedded
+    // struct frees exactly what it points to
+
+    void FillCommonHardwareState(const ommo::CommonHardwareState& state, ommo::api::CommonHardwareState& common_hardware_state)
+    {
+        // Both strings share one block
+        PooledArrayBlock block;
+        block.Reserve<char>(state.serial_number().length() + 1);
+        block.Reserve<char>(state.usb_port_name().length() + 1);
+        block.Allocate();
+
+        common_hardware_state.connected = state.connected();
+
+        common_hardware_state.serial_number = block.Place<char>(state.serial_number().length() + 1);
+        std::strcpy(common_hardware_state.serial_number, state.serial_number().c_str());
+
+        common_hardware_state.uuid = state.uuid();
+
+        common_hardware_state.usb_port_name = block.Place<char>(state.usb_port_name().length() + 1);
+        std::strcpy(common_hardware_state.usb_port_name, state.usb_port_name().c_str());
+
+        common_hardware_state.hardware_status = ommo::ProtoToHardwareStatus(state.hardware_status());
+    }
+
+    void FillBasestationHardwareState(const ommo::BasestationHardwareState& bs_state, ommo::api::BasestationHardwareState& basestation_hardware_state)
+    {
+        FillCommonHardwareState(bs_state.common_state(), basestation_hardware_state.common_state);
+        basestation_hardware_state.sync_channel = bs_state.sync_channel();
+        basestation_hardware_state.direct_comm_status = ommo::ProtoToDirectCommStatus(bs_state.direct_comm_status());
+        basestation_hardware_state.direct_comm_uuid = bs_state.direct_comm_uuid();
+        basestation_hardware_state.motor_running = bs_state.motor_running();
+    }
+
+    void FillSIUHardwareState(const ommo::SIUHardwareState& siu_state, ommo::api::SIUHardwareState& siu_hardware_state)
+    {
+        FillCommonHardwareState(siu_state.common_state(), siu_hardware_state.common_state);
+        siu_hardware_state.wireless = siu_state.wireless();
+        siu_hardware_state.sync_channel = siu_state.sync_channel();
+        siu_hardware_state.data_channel = siu_state.data_channel();
+
+        // Sensor Device States
+        siu_hardware_state.sensor_device_state_count = siu_state.sensor_device_states_size();
+        siu_hardware_state.sensor_device_states = ommo::NewPooledArray<ommo::api::SensorDeviceState>(siu_hardware_state.sensor_device_state_count);
+        for (int sensor_index = 0; sensor_index < siu_state.sensor_device_states_size(); sensor_index++)
+        {
+            siu_hardware_state.sensor_device_states[sensor_index] = ommo::ProtoToSensorDeviceState(siu_state.sensor_device_states(sensor_index));
+        }
+    }
+
+    void FillWirelessReceiverHardwareState(const ommo::WirelessReceiverHardwareState& wr_state, ommo::api::WirelessReceiverHardwareState& wireless_receiver_hardware_state)
+    {
+        FillCommonHardwareState(wr_state.common_state(), wireless_receiver_hardware_state.common_state);
+        wireless_receiver_hardware_state.data_channel = wr_state.data_channel();
+
+        // Receiver Connections
+        wireless_receiver_hardware_state.connected_siu_count = wr_state.connected_sius_size();
+        wireless_receiver_hardware_state.connected_sius = ommo::NewPooledArray<ommo::api::ReceiverConnection>(wireless_receiver_hardware_state.connected_siu_count);
+        for (int siu_index = 0; siu_index < wr_state.connected_sius_size(); siu_index++)
+        {
+            wireless_receiver_hardware_state.connected_sius[siu_index] = ommo::ProtoToRecevierConnection(wr_state.connected_sius(siu_index));
+        }
+    }
+
+    // Convert the DeviceDataPart flags in <parts>. Instantiated for every combination, so a stream that requests only
+    // poses does not test or walk the fields of the other parts.
+    template <uint32_t parts>
+    void ConvertTrackingDeviceData(const ommo::TrackingDeviceData& data, ommo::api::TrackingDeviceData& tracking_device_data)
+    {
+        tracking_device_data.siu_uuid = data.siu_uuid();
+        tracking_device_data.port_id = data.port_id();
+        tracking_device_data.basestation_angle = data.basestation_angle();
+        tracking_device_data.basestation_speed = data.basestation_speed();
+        tracking_device_data.timestamp = data.timestamp();
+
+        // Raw Sensor Data
+        tracking_device_data.raw_sensor_data_count = 0;
+        if constexpr ((parts & ommo::kDeviceDataRawSensorData) != 0)
+        {
+            tracking_device_data.raw_sensor_data_count = data.raw_sensor_data_size();
+            for (int raw_data = 0; raw_data < data.raw_sensor_data_size(); raw_data++)
+            {
+                tracking_device_data.raw_sensor_data[raw_data] = ommo::ProtoToRawSensorData(data.raw_sensor_data(raw_data));
+            }
+        }
+
+        // Battery States
+        if ((parts & ommo::kDeviceDataBatteryState) != 0 && data.has_battery_state())
+        {
+            tracking_device_data.battery_state = ommo::ProtoToBatteryInfo(data.battery_state());
+        }
+        else
+        {
+            tracking_device_data.battery_state.state_of_charge = -1;
+            tracking_device_data.battery_state.current = -1;
+            tracking_device_data.battery_state.remaining_capacity = -1;
+        }
+
+        // Poses - use positions_size() since positions, quaternions, and indicator values always have the same size
+        tracking_device_data.pose_count = data.positions_size();
+        for (int pose_index = 0; pose_index < data.positions_size(); pose_index++)
+        {
+            tracking_device_data.poses[pose_index].position = ommo::ProtoToVector3f(data.positions(pose_index));
+            tracking_device_data.poses[pose_index].quaternion = ommo::ProtoToVector4f(data.quaternions(pose_index));
+            tracking_device_data.poses[pose_index].indicator_value = data.indicator_values(pose_index);
+            tracking_device_data.poses[pose_index].motion_indicator = pose_index < data.motion_indicators_size() ? data.motion_indicators(pose_index) : 0;
+            tracking_device_data.poses[pose_index].bad_data_indicator = pose_index < data.bad_data_indicators_size() ? data.bad_data_indicators(pose_index) : 0;
+        }
+
+        // Buttons
+        tracking_device_data.button_count = 0;
+        if constexpr ((parts & ommo::kDeviceDataButtons) != 0)
+        {
+            tracking_device_data.button_count = data.buttons_size();
+            for (int i = 0; i < data.buttons_size(); i++)
+            {
+                tracking_device_data.buttons[i] = (ommo::api::ButtonState)data.buttons(i);
+            }
+        }
+
+        // Latency Timestamps
+        tracking_device_data.latency_timestamp_count = data.latency_timestamps_size();
+        for (int i = 0; i < data.latency_timestamps_size(); i++)
+        {
+            tracking_device_data.latency_timestamps[i].timestamp_type = (ommo::api::TimestampType)data.latency_timestamps(i).timestamp_type();
+            tracking_device_data.latency_timestamps[i].steady_timestamp_milliseconds = data.latency_timestamps(i).steady_timestamp_milliseconds();
+            tracking_device_data.latency_timestamps[i].system_timestamp_milliseconds = data.latency_timestamps(i).system_timestamp_milliseconds();
+        }
+    }
+
+    using DeviceDataConverter = void (*)(const ommo::TrackingDeviceData&, ommo::api::TrackingDeviceData&);
+
+    // Indexed by the DeviceDataPart flags
+    constexpr DeviceDataConverter device_data_converters[] = {
+        &ConvertTrackingDeviceData<0>, &ConvertTrackingDeviceData<1>, &ConvertTrackingDeviceData<2>, &ConvertTrackingDeviceData<3>,
+        &ConvertTrackingDeviceData<4>, &ConvertTrackingDeviceData<5>, &ConvertTrackingDeviceData<6>, &ConvertTrackingDeviceData<7>
+    };
+    static_assert(sizeof(device_data_converters) / sizeof(device_data_converters[0]) == ommo::kAllDeviceDataParts + 1, "One converter per part combination");
+
+    void ReserveTrackingDeviceData(PooledArrayBlock& block, const ommo::TrackingDeviceData& data, uint32_t parts)
+    {
+        const ommo::DeviceDataCounts counts = ommo::GetDeviceDataCounts(data, parts);
+        ommo::ReserveTrackingDeviceDataMembers(block, counts.raw_sensor_data_count, counts.pose_count, counts.button_count, counts.latency_timestamp_count);
+    }
+
+    void PlaceTrackingDeviceData(PooledArrayBlock& block, const ommo::TrackingDeviceData& data, ommo::api::TrackingDeviceData& tracking_device_data, uint32_t parts)
+    {
+        const ommo::DeviceDataCounts counts = ommo::GetDeviceDataCounts(data, parts);
+        ommo::PlaceTrackingDeviceDataMembers(block, tracking_device_data, counts.raw_sensor_data_count, counts.pose_count, counts.button_count, counts.latency_timestamp_count);
+        device_data_converters[parts & ommo::kAllDeviceDataParts](data, tracking_device_data);
+    }
+}
 
 namespace ommo
 {
@@ -67,8 +224,13 @@ namespace ommo
         device_descriptor->device_part_number = descriptor.device_part_number();
         device_descriptor->secure_device_info = descriptor.secure_device_info();
 
+        // Both member arrays share one block
+        PooledArrayBlock block;
+        ReserveDeviceDescriptorMembers(block, descriptor.sensor_unit_descriptors_size(), descriptor.supported_fusion_modes_size());
+        block.Allocate();
+        PlaceDeviceDescriptorMembers(block, *device_descriptor, descriptor.sensor_unit_descriptors_size(), descriptor.supported_fusion_modes_size());
+
         device_descriptor->sensor_unit_descriptor_count = descriptor.sensor_unit_descriptors_size();
-        device_descriptor->sensor_unit_descriptors = new api::SensorUnitDescriptor[device_descriptor->sensor_unit_descriptor_count];
         // Sensor Unit Descriptors
         for (int sensor_index = 0; sensor_index < descriptor.sensor_unit_descriptors_size(); sensor_index++)
         {
@@ -76,7 +238,6 @@ namespace ommo
         }
 
         device_descriptor->supported_fusion_modes_count = descriptor.supported_fusion_modes_size();
-        device_descriptor->supported_fusion_modes = new api::DeviceFusionMode[device_descriptor->supported_fusion_modes_count];
         // Supported Fusion Modes
         for (int fusion_index = 0; fusion_index < descriptor.supported_fusion_modes_size(); fusion_index++)
         {
@@ -118,17 +279,7 @@ namespace ommo
     api::CommonHardwareStateUPtr ProtoToCommonHardwareState(const ommo::CommonHardwareState& state)
     {
         api::CommonHardwareStateUPtr common_hardware_state(new api::CommonHardwareState);
-        common_hardware_state->connected = state.connected();
-
-        common_hardware_state->serial_number = new char[state.serial_number().length() + 1];
-        std::strcpy(common_hardware_state->serial_number, state.serial_number().c_str());
-
-        common_hardware_state->uuid = state.uuid();
-
-        common_hardware_state->usb_port_name = new char[state.usb_port_name().length() + 1];
-        std::strcpy(common_hardware_state->usb_port_name, state.usb_port_name().c_str());
-
-        common_hardware_state->hardware_status = ommo::ProtoToHardwareStatus(state.hardware_status());
+        FillCommonHardwareState(state, *common_hardware_state);
         return common_hardware_state;
     }
 
@@ -156,50 +307,21 @@ namespace ommo
     api::BasestationHardwareStateUPtr ProtoToBasestationHardwareState(const ommo::BasestationHardwareState& bs_state)
     {
         api::BasestationHardwareStateUPtr basestation_hardware_state(new api::BasestationHardwareState);
-        // Dereference to copy and release the pointer so basestation_hardware_state now owns the memory
-        api::MoveUniquePtr(basestation_hardware_state->common_state, ProtoToCommonHardwareState(bs_state.common_state()));
-        basestation_hardware_state->sync_channel = bs_state.sync_channel();
-        basestation_hardware_state->direct_comm_status = ommo::ProtoToDirectCommStatus(bs_state.direct_comm_status());
-        basestation_hardware_state->direct_comm_uuid = bs_state.direct_comm_uuid();
-        basestation_hardware_state->motor_running = bs_state.motor_running();
+        FillBasestationHardwareState(bs_state, *basestation_hardware_state);
         return basestation_hardware_state;
     }
 
     api::SIUHardwareStateUPtr ProtoToSIUHardwareState(const ommo::SIUHardwareState& siu_state)
     {
         api::SIUHardwareStateUPtr siu_hardware_state(new api::SIUHardwareState);
-        // Dereference to copy and release the pointer so siu_hardware_state now owns the memory
-        api::MoveUniquePtr(siu_hardware_state->common_state, ProtoToCommonHardwareState(siu_state.common_state()));
-        siu_hardware_state->wireless = siu_state.wireless();
-        siu_hardware_state->sync_channel = siu_state.sync_channel();
-        siu_hardware_state->data_channel = siu_state.data_channel();
-
-        // Sensor Device States
-        siu_hardware_state->sensor_device_state_count = siu_state.sensor_device_states_size();
-        siu_hardware_state->sensor_device_states = new api::SensorDeviceState[siu_hardware_state->sensor_device_state_count];
-        for (int sensor_index = 0; sensor_index < siu_state.sensor_device_states_size(); sensor_index++)
-        {
-            siu_hardware_state->sensor_device_states[sensor_index] = ProtoToSensorDeviceState(siu_state.sensor_device_states(sensor_index));
-        }
-
+        FillSIUHardwareState(siu_state, *siu_hardware_state);
         return siu_hardware_state;
     }
 
     api::WirelessReceiverHardwareStateUPtr ProtoToWirelessReceiverHardwareState(const ommo::WirelessReceiverHardwareState& wr_state)
     {
         api::WirelessReceiverHardwareStateUPtr wireless_receiver_hardware_state(new api::WirelessReceiverHardwareState);
-        // Dereference to copy and release the pointer so wireless_receiver_hardware_state now owns the memory
-        api::MoveUniquePtr(wireless_receiver_hardware_state->common_state, ProtoToCommonHardwareState(wr_state.common_state()));
-        wireless_receiver_hardware_state->data_channel = wr_state.data_channel();
-
-        // Receiver Connections
-        wireless_receiver_hardware_state->connected_siu_count = wr_state.connected_sius_size();
-        wireless_receiver_hardware_state->connected_sius = new api::ReceiverConnection[wireless_receiver_hardware_state->connected_siu_count];
-        for (int siu_index = 0; siu_index < wr_state.connected_sius_size(); siu_index++)
-        {
-            wireless_receiver_hardware_state->connected_sius[siu_index] = ProtoToRecevierConnection(wr_state.connected_sius(siu_index));
-        }
-
+        FillWirelessReceiverHardwareState(wr_state, *wireless_receiver_hardware_state);
         return wireless_receiver_hardware_state;
     }
 
@@ -209,29 +331,26 @@ namespace ommo
 
         // Basestation States
         hardware_states->basestation_state_count = hw_states.basestation_states_size();
-        hardware_states->basestation_states = new api::BasestationHardwareState[hardware_states->basestation_state_count];
+        hardware_states->basestation_states = ommo::NewPooledArray<api::BasestationHardwareState>(hardware_states->basestation_state_count);
         for (int bs_state = 0; bs_state < hw_states.basestation_states_size(); bs_state++)
         {
-            // Dereference to copy and release the pointer so hardware_states now owns the memory
-            api::MoveUniquePtr(hardware_states->basestation_states[bs_state], ProtoToBasestationHardwareState(hw_states.basestation_states(bs_state)));
+            FillBasestationHardwareState(hw_states.basestation_states(bs_state), hardware_states->basestation_states[bs_state]);
         }
 
         // SIU States
         hardware_states->siu_state_count = hw_states.siu_states_size();
-        hardware_states->siu_states = new api::SIUHardwareState[hardware_states->siu_state_count];
+        hardware_states->siu_states = ommo::NewPooledArray<api::SIUHardwareState>(hardware_states->siu_state_count);
         for (int siu_state = 0; siu_state < hw_states.siu_states_size(); siu_state++)
         {
-            // Dereference to copy and release the pointer so hardware_states now owns the memory
-            api::MoveUniquePtr(hardware_states->siu_states[siu_state], ommo::ProtoToSIUHardwareState(hw_states.siu_states(siu_state)));
+            FillSIUHardwareState(hw_states.siu_states(siu_state), hardware_states->siu_states[siu_state]);
         }
 
         // Wireless Receiver States
         hardware_states->wireless_receiver_state_count = hw_states.wireless_receiver_states_size();
-        hardware_states->wireless_receiver_states = new api::WirelessReceiverHardwareState[hardware_states->wireless_receiver_state_count];
+        hardware_states->wireless_receiver_states = ommo::NewPooledArray<api::WirelessReceiverHardwareState>(hardware_states->wireless_receiver_state_count);
         for (int wr_state = 0; wr_state < hw_states.wireless_receiver_states_size(); wr_state++)
         {
-            // Dereference to copy and release the pointer so hardware_states now owns the memory
-            api::MoveUniquePtr(hardware_states->wireless_receiver_states[wr_state], ommo::ProtoToWirelessReceiverHardwareState(hw_states.wireless_receiver_states(wr_state)));
+            FillWirelessReceiverHardwareState(hw_states.wireless_receiver_states(wr_state), hardware_states->wireless_receiver_states[wr_state]);
         }
 
         return hardware_states;
@@ -256,83 +375,62 @@ namespace ommo
         return b_state;
     }
 
-    api::TrackingDeviceDataUPtr ProtoToTrackingDeviceData(const ommo::TrackingDeviceData& data)
+    void ProtoToTrackingDeviceData(const ommo::TrackingDeviceData& data, api::TrackingDeviceData& tracking_device_data, uint32_t parts)
     {
-        api::TrackingDeviceDataUPtr tracking_device_data(new api::TrackingDeviceData);
-
-        tracking_device_data->siu_uuid = data.siu_uuid();
-        tracking_device_data->port_id = data.port_id();
-        tracking_device_data->basestation_angle = data.basestation_angle();
-        tracking_device_data->basestation_speed = data.basestation_speed();
-        tracking_device_data->timestamp = data.timestamp();
-
-        // Raw Sensor Data
-        tracking_device_data->raw_sensor_data_count = data.raw_sensor_data_size();
-        tracking_device_data->raw_sensor_data = new api::RawSensorData[tracking_device_data->raw_sensor_data_count];
-        for (int raw_data = 0; raw_data < data.raw_sensor_data_size(); raw_data++)
-        {
-            tracking_device_data->raw_sensor_data[raw_data] = ProtoToRawSensorData(data.raw_sensor_data(raw_data));
-        }
-
-        // Battery States
-        if (data.has_battery_state())
-        {
-            tracking_device_data->battery_state = ProtoToBatteryInfo(data.battery_state());
-        }
-        else
-        {
-            tracking_device_data->battery_state.state_of_charge = -1;
-            tracking_device_data->battery_state.current = -1;
-            tracking_device_data->battery_state.remaining_capacity = -1;
-        }
-
-        // Poses - use positions_size() since positions, quaternions, and indicator values always have the same size
-        tracking_device_data->pose_count = data.positions_size();
-        tracking_device_data->poses = new api::PoseData[tracking_device_data->pose_count];
-        for (int pose_index = 0; pose_index < tracking_device_data->pose_count; pose_index++)
-        {
-            tracking_device_data->poses[pose_index].position = ProtoToVector3f(data.positions(pose_index));
-            tracking_device_data->poses[pose_index].quaternion = ProtoToVector4f(data.quaternions(pose_index));
-            tracking_device_data->poses[pose_index].indicator_value = data.indicator_values(pose_index);
-            tracking_device_data->poses[pose_index].motion_indicator = pose_index < data.motion_indicators_size() ? data.motion_indicators(pose_index) : 0;
-            tracking_device_data->poses[pose_index].bad_data_indicator = pose_index < data.bad_data_indicators_size() ? data.bad_data_indicators(pose_index) : 0;
-        }
+        device_data_converters[parts & kAllDeviceDataParts](data, tracking_device_data);
+    }
 
-        // Buttons
-        tracking_device_data->button_count = data.buttons_size();
-        tracking_device_data->buttons = new api::ButtonState[tracking_device_data->button_count];
-        for (int i = 0; i < tracking_device_data->button_count; i++)
-        {
-            tracking_device_data->buttons[i] = (api::ButtonState)data.buttons(i);
-        }
+    DeviceDataCounts GetDeviceDataCounts(const ommo::TrackingDeviceData& data, uint32_t parts)
+    {
+        DeviceDataCounts counts;
+        counts.raw_sensor_data_count = (parts & kDeviceDataRawSensorData) != 0 ? data.raw_sensor_data_size() : 0;
+        counts.pose_count = data.positions_size();
+        counts.button_count = (parts & kDeviceDataButtons) != 0 ? data.buttons_size() : 0;
+        counts.latency_timestamp_count = data.latency_timestamps_size();
+        return counts;
+    }
 
-        // Latency Timestamps
-        tracking_device_data->latency_timestamp_count = data.latency_timestamps_size();
-        tracking_device_data->latency_timestamps = new api::TimestampData[tracking_device_data->latency_timestamp_count];
-        for (int i = 0; i < tracking_device_data->latency_timestamp_count; i++)
-        {
-            tracking_device_data->latency_timestamps[i].timestamp_type = (api::TimestampType)data.latency_timestamps(i).timestamp_type();
-            tracking_device_data->latency_timestamps[i].steady_timestamp_milliseconds = data.latency_timestamps(i).steady_timestamp_milliseconds();
-            tracking_device_data->latency_timestamps[i].system_timestamp_milliseconds = data.latency_timestamps(i).system_timestamp_milliseconds();
-        }
+    api::TrackingDeviceDataUPtr ProtoToTrackingDeviceData(const ommo::TrackingDeviceData& data, uint32_t parts)
+    {
+        api::TrackingDeviceDataUPtr tracking_device_data(new api::TrackingDeviceData);
 
+        // All member arrays share one block
+        PooledArrayBlock block;
+        ReserveTrackingDeviceData(block, data, parts);
+        block.Allocate();
+        PlaceTrackingDeviceData(block, data, *tracking_device_data, parts);
         return tracking_device_data;
     }
 
-    api::DataFrameUPtr ProtoToDataFrame(const ommo::DataFrame& frame)
+    api::DataFrameUPtr ProtoToDataFrame(const ommo::DataFrame& frame, uint32_t parts)
     {
         api::DataFrameUPtr data_frame(new api::DataFrame);
 
         data_frame->device_data_count = frame.device_data_size();
-        data_frame->device_data = new api::TrackingDeviceData[data_frame->device_data_count];
+        data_frame->device_data = ommo::NewPooledArray<api::TrackingDeviceData>(data_frame->device_data_count);
         for (int device_index = 0; device_index < frame.device_data_size(); device_index++)
         {
-            // Dereference to copy and release the pointer so data_frame now owns the memory
-            api::MoveUniquePtr(data_frame->device_data[device_index], ProtoToTrackingDeviceData(frame.device_data(device_index)));
+            // Every device keeps its own member block, so it can be released like a standalone device data
+            const ommo::TrackingDeviceData& data = frame.device_data(device_index);
+            PooledArrayBlock block;
+            ReserveTrackingDeviceData(block, data, parts);
+            block.Allocate();
+            PlaceTrackingDeviceData(block, data, data_frame->device_data[device_index], parts);
         }
         return data_frame;
     }
 
+    api::TrackingDeviceDataSPtr ProtoToSharedTrackingDeviceData(const ommo::TrackingDeviceData& data, uint32_t parts)
+    {
+        // The shared pointer takes over the deleter of the unique pointer
+        return ProtoToTrackingDeviceData(data, parts);
+    }
+
+    api::DataFrameSPtr ProtoToSharedDataFrame(const ommo::DataFrame& frame, uint32_t parts)
+    {
+        return ProtoToDataFrame(frame, parts);
+    }
+
     api::DeviceFusionMode ProtoToDeviceFusionMode(const ommo::DeviceFusionMode& fusion_mode)
     {
         return static_cast<api::DeviceFusionMode>(fusion_mode);
@@ -9,8 +9,8 @@
 #include "rpcClientCallData.h"
 
 
-rpcClientCallData::rpcClientCallData(std::shared_ptr<Channel> channel, CompletionQueue* cq, ClientCallState status, std::weak_ptr<ommo::CallDataAssociation> association) :
-    channel(channel), completion_queue(cq), status(status), stub(ommo::CoreService::NewStub(channel)), association_(association)
+rpcClientCallData::rpcClientCallData(std::shared_ptr<ommo::CoreService::Stub> stub, CompletionQueue* cq, ClientCallState status, std::weak_ptr<ommo::CallDataAssociation> association) :
+    completion_queue(cq), status(status), stub(stub), association_(association)
 {
     /*
      * Set the internal CallDataInfo to point to this.
@@ -14,11 +14,11 @@ using grpc::ClientAsyncReader;
 
 
 rpcOpenTrackingDevicesEventStreamClientCallData::rpcOpenTrackingDevicesEventStreamClientCallData(
-	std::shared_ptr<Channel> channel, 
+	std::shared_ptr<ommo::CoreService::Stub> stub, 
 	CompletionQueue* cq, 
 	const ommo::TrackingDevicesEventStreamRequest& request, 
 	const std::function<void(const ommo::TrackingDeviceEvent&)> cb_handler)
-	: rpcClientCallData(channel, cq, ClientCallState::CONNECTING), cb_handler_(cb_handler)
+	: rpcClientCallData(stub, cq, ClientCallState::CONNECTING), cb_handler_(cb_handler)
 {
 	// Prepare call get reader
 	reader_ = stub->PrepareAsyncOpenTrackingDevicesEventStream(&grpc_client_context, request, completion_queue);
@@ -39,20 +39,21 @@ bool rpcOpenTrackingDevicesEventStreamClientCallData::Proceed(OperationType op_t
 	if (status == ClientCallState::CONNECTING)
 	{
 		// Start a read
-		reader_->Read(&response_, &internal_read_info);
+		reader_->Read(responses_.NextReadSlot(), &internal_read_info);
 		status = ClientCallState::PROCESSING;
 
 		return true;
 	}
 	else if (status == ClientCallState::PROCESSING)
 	{
-		// Read finished send to cb_handler_
+		// Read finished. Start the next read into the other slot before handing the message to cb_handler_
+		const auto& received = responses_.CompleteRead();
+		reader_->Read(responses_.NextReadSlot(), &internal_read_info);
+
 		if (listener_active && cb_handler_)
 		{
-			cb_handler_(response_);
+			cb_handler_(received);
 		}
-		// Start another read
-		reader_->Read(&response_, &internal_read_info);
 
 		return true;
 	}
@@ -14,13 +14,13 @@
 using grpc::ClientAsyncReader;
 
 RpcBaseStationDataStreamClientCallData::RpcBaseStationDataStreamClientCallData(
-    std::shared_ptr<Channel> channel, 
+    std::shared_ptr<ommo::CoreService::Stub> stub, 
     CompletionQueue* cq, 
     const ommo::BaseStationDataStreamRequest &request, 
     const std::function<void(const ommo::BaseStationData&)> cb_handler, 
     std::weak_ptr<ommo::CallDataAssociation> association)
     : rpcClientCallData(
-        channel, cq, ClientCallState::CONNECTING,
+        stub, cq, ClientCallState::CONNECTING,
         association
     ), cb_handler_(cb_handler)
 {
@@ -43,22 +43,22 @@ bool RpcBaseStationDataStreamClientCallData::Proceed(OperationType op_type)
     if (status == ClientCallState::CONNECTING)
     {       
         // Start a read
-        reader_->Read(&response_, &internal_read_info);
+        reader_->Read(responses_.NextReadSlot(), &internal_read_info);
         status = ClientCallState::PROCESSING;
 
         return true;
     }
     else if (status == ClientCallState::PROCESSING)
     {
-        // Read finished send to callback_handler
+        // Read finished. Start the next read into the other slot before handing the message to cb_handler_
+        const auto& received = responses_.CompleteRead();
+        reader_->Read(responses_.NextReadSlot(), &internal_read_info);
+
         if (listener_active && cb_handler_)
         {
-            cb_handler_(response_);
+            cb_handler_(received);
         }
 
-        // Start another read
-        reader_->Read(&response_, &internal_read_info);
-
         return true;
     }
     else
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#include "rpc_encoded_stream_client_call_data.h"
+
+#include <grpc/support/log.h>
+#include <cassert>
+
+RpcEncodedStreamClientCallData::RpcEncodedStreamClientCallData(
+    std::shared_ptr<ommo::CoreService::Stub> stub, 
+    std::shared_ptr<grpc::GenericStub> generic_stub, 
+    CompletionQueue* cq, 
+    const std::string& method, 
+    const google::protobuf::Message& request, 
+    const std::function<void(const uint8_t*, size_t)> cb_handler, 
+    std::weak_ptr<ommo::CallDataAssociation> association)
+    : rpcClientCallData(stub, cq, ClientCallState::CONNECTING, association), cb_handler_(cb_handler), generic_stub_(generic_stub)
+{
+    const std::string serialized_request = request.SerializeAsString();
+    grpc::Slice request_slice(serialized_request);
+    request_ = grpc::ByteBuffer(&request_slice, 1);
+
+    // Prepare call get bidirectional reader/writer
+    stream_handler_ = generic_stub_->PrepareCall(&grpc_client_context, method, completion_queue);
+
+    // StartCall initiates the RPC call
+    stream_handler_->StartCall(&internal_read_info);
+
+    if (cb_handler)
+    {
+        listener_active = true;
+    }
+}
+
+bool RpcEncodedStreamClientCallData::Proceed(OperationType op_type)
+{
+    rwlock_wrlockguard lock(statusLock);
+
+    if (status == ClientCallState::CONNECTING)
+    {
+        // Send the request and close the sending side of the call
+        stream_handler_->WriteLast(request_, grpc::WriteOptions(), &internal_write_info);
+        status = ClientCallState::WAITING;
+
+        return true;
+    }
+    else if (status == ClientCallState::WAITING)
+    {
+        // Request written, start a read
+        assert(op_type == OperationType::WRITE);
+        stream_handler_->Read(responses_.NextReadSlot(), &internal_read_info);
+        status = ClientCallState::PROCESSING;
+
+        return true;
+    }
+    else if (status == ClientCallState::PROCESSING)
+    {
+        // Read finished. Take the bytes of the message, then start the next read into the other slot before
+        // handing them to cb_handler_. A message received in several slices is copied into one.
+        const grpc::ByteBuffer& received = responses_.CompleteRead();
+        grpc::Slice bytes;
+        if (!received.TrySingleSlice(&bytes).ok() && !received.DumpToSingleSlice(&bytes).ok())
+        {
+            bytes = grpc::Slice();
+        }
+        stream_handler_->Read(responses_.NextReadSlot(), &internal_read_info);
+
+        if (listener_active && cb_handler_)
+        {
+            cb_handler_(bytes.begin(), bytes.size());
+        }
+
+        return true;
+    }
+    else
+    {
+        // Once in the FINISH state, deallocate ourselves (CallData).
+        assert(status == ClientCallState::FINISH);
+        //Delete this object
+        return false;
+    }
+}
@@ -12,8 +12,8 @@
 
 using grpc::ClientAsyncReader;
 
-RpcTrackingGroupsEventStreamClientCallData::RpcTrackingGroupsEventStreamClientCallData(std::shared_ptr<Channel> channel, CompletionQueue* cq, const ommo::TrackingGroupsEventStreamRequest &request, const std::function<void(const ommo::TrackingGroupEvent&)> cb_handler)
-    : rpcClientCallData(channel, cq, ClientCallState::CONNECTING), cb_handler_(cb_handler)
+RpcTrackingGroupsEventStreamClientCallData::RpcTrackingGroupsEventStreamClientCallData(std::shared_ptr<ommo::CoreService::Stub> stub, CompletionQueue* cq, const ommo::TrackingGroupsEventStreamRequest &request, const std::function<void(const ommo::TrackingGroupEvent&)> cb_handler)
+    : rpcClientCallData(stub, cq, ClientCallState::CONNECTING), cb_handler_(cb_handler)
 {
     // Prepare call get reader
     reader_ = stub->PrepareAsyncOpenTrackingGroupsEventStream(&grpc_client_context, request, completion_queue);
@@ -34,20 +34,21 @@ bool RpcTrackingGroupsEventStreamClientCallData::Proceed(OperationType op_type)
     if (status == ClientCallState::CONNECTING)
     {
         // Start a read
-        reader_->Read(&response_, &internal_read_info);
+        reader_->Read(responses_.NextReadSlot(), &internal_read_info);
         status = ClientCallState::PROCESSING;
 
         return true;
     }
     else if (status == ClientCallState::PROCESSING)
     {
-        // Read finished send to listener
+        // Read finished. Start the next read into the other slot before handing the message to cb_handler_
+        const auto& received = responses_.CompleteRead();
+        reader_->Read(responses_.NextReadSlot(), &internal_read_info);
+
         if (listener_active && cb_handler_)
         {
-            cb_handler_(response_);
+            cb_handler_(received);
         }
-        // Start another read
-        reader_->Read(&response_, &internal_read_info);
 
         return true;
     }
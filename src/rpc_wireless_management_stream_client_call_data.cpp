@@ -14,11 +14,11 @@
 using grpc::ClientAsyncReader;
 
 RpcWirelessManagementStreamClientCallData::RpcWirelessManagementStreamClientCallData(
-    std::shared_ptr<Channel> channel, 
+    std::shared_ptr<ommo::CoreService::Stub> stub, 
     CompletionQueue* cq, 
     const std::function<void(const ommo::WirelessManagementEvent&)> cb_handler, 
     std::weak_ptr<ommo::CallDataAssociation> association)
-    : rpcClientCallData(channel, cq, ClientCallState::CONNECTING, association), cb_handler_(cb_handler)
+    : rpcClientCallData(stub, cq, ClientCallState::CONNECTING, association), cb_handler_(cb_handler)
 {
     // Prepare call get bidirectional reader/writer
     stream_handler_ = stub->PrepareAsyncOpenWirelessManagementStream(&grpc_client_context, completion_queue);
@@ -59,7 +59,7 @@ bool RpcWirelessManagementStreamClientCallData::Proceed(OperationType op_type)
     {
         // Start a read
         status = ClientCallState::WAITING;
-        stream_handler_->Read(&response_, &internal_read_info);
+        stream_handler_->Read(responses_.NextReadSlot(), &internal_read_info);
 
         return true;
     }
@@ -68,13 +68,14 @@ bool RpcWirelessManagementStreamClientCallData::Proceed(OperationType op_type)
         // Read finished send to callback_handler
         if (op_type == OperationType::READ)
         {
+            // Start the next read into the other slot before handing the message to cb_handler_
+            const auto& received = responses_.CompleteRead();
+            stream_handler_->Read(responses_.NextReadSlot(), &internal_read_info);
+
             if (cb_handler_ && listener_active)
             {
-                cb_handler_(response_);
+                cb_handler_(received);
             }
-
-            // Start another read
-            stream_handler_->Read(&response_, &internal_read_info);
             // No need to change state since we are just waiting for more reads
         }
 
@@ -85,13 +86,14 @@ bool RpcWirelessManagementStreamClientCallData::Proceed(OperationType op_type)
         // Read finished while waiting for write send to callback_handler
         if (op_type == OperationType::READ)
         {
+            // Start the next read into the other slot before handing the message to cb_handler_
+            const auto& received = responses_.CompleteRead();
+            stream_handler_->Read(responses_.NextReadSlot(), &internal_read_info);
+
             if (cb_handler_ && listener_active)
             {
-                cb_handler_(response_);
+                cb_handler_(received);
             }
-
-            // Start another read
-            stream_handler_->Read(&response_, &internal_read_info);
             // No need to change state since we are still waiting for write to finish
         }
         else if (op_type == OperationType::WRITE)
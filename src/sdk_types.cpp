@@ -7,6 +7,8 @@
 */
 
 #include "sdk_types.h"
+#include "api_member_blocks.h"
+#include "device_data_storage.h"
 
 #include <cstring>
 
@@ -25,6 +27,22 @@ namespace ommo::api {
         return req;
     }
 
+    DevicePacketBuffer* CreateDevicePacketBuffer(uint32_t packet_capacity, uint32_t raw_sensor_data_capacity, uint32_t pose_capacity, uint32_t button_capacity, uint32_t latency_timestamp_capacity)
+    {
+        DevicePacketBuffer* buffer = new DevicePacketBuffer{ nullptr, 0, 0, packet_capacity, raw_sensor_data_capacity, pose_capacity, button_capacity, latency_timestamp_capacity };
+
+        buffer->packets = ommo::NewZeroedPooledArray<DevicePacket>(packet_capacity);
+        for (uint32_t i = 0; i < packet_capacity; i++)
+        {
+            // The member arrays of every packet share one block
+            ommo::PooledArrayBlock block;
+            ommo::ReserveTrackingDeviceDataMembers(block, raw_sensor_data_capacity, pose_capacity, button_capacity, latency_timestamp_capacity);
+            block.Allocate();
+            ommo::PlaceTrackingDeviceDataMembers(block, buffer->packets[i].device_data, raw_sensor_data_capacity, pose_capacity, button_capacity, latency_timestamp_capacity);
+        }
+        return buffer;
+    }
+
     DeviceDescriptor* CopyDeviceDescriptor(const DeviceDescriptor& source)
     {
         DeviceDescriptor* new_des = new DeviceDescriptor;
@@ -35,8 +53,13 @@ namespace ommo::api {
         new_des->device_part_number = source.device_part_number;
         new_des->secure_device_info = source.secure_device_info;
 
+        // Both member arrays share one block
+        ommo::PooledArrayBlock block;
+        ommo::ReserveDeviceDescriptorMembers(block, source.sensor_unit_descriptor_count, source.supported_fusion_modes_count);
+        block.Allocate();
+        ommo::PlaceDeviceDescriptorMembers(block, *new_des, source.sensor_unit_descriptor_count, source.supported_fusion_modes_count);
+
         new_des->sensor_unit_descriptor_count = source.sensor_unit_descriptor_count;
-        new_des->sensor_unit_descriptors = new SensorUnitDescriptor[new_des->sensor_unit_descriptor_count];
         for (int i = 0; i < new_des->sensor_unit_descriptor_count; i++)
         {
             // Performs an implicit copy given that SensorUnitDescriptor does not require a deep copy
@@ -44,7 +67,6 @@ namespace ommo::api {
         }
 
         new_des->supported_fusion_modes_count = source.supported_fusion_modes_count;
-        new_des->supported_fusion_modes = new DeviceFusionMode[new_des->supported_fusion_modes_count];
         for (int i = 0; i < new_des->supported_fusion_modes_count; i++)
         {
             // Performs an implicit copy given that DeviceFusionMode does not require a deep copy
@@ -71,8 +93,13 @@ namespace ommo::api {
         new_data->basestation_speed = source.basestation_speed;
         new_data->timestamp = source.timestamp;
 
+        // All member arrays share one block
+        ommo::PooledArrayBlock block;
+        ommo::ReserveTrackingDeviceDataMembers(block, source.raw_sensor_data_count, source.pose_count, source.button_count, source.latency_timestamp_count);
+        block.Allocate();
+        ommo::PlaceTrackingDeviceDataMembers(block, *new_data, source.raw_sensor_data_count, source.pose_count, source.button_count, source.latency_timestamp_count);
+
         new_data->raw_sensor_data_count = source.raw_sensor_data_count;
-        new_data->raw_sensor_data = new RawSensorData[new_data->raw_sensor_data_count];
         for (int i = 0; i < new_data->raw_sensor_data_count; i++)
         {
             new_data->raw_sensor_data[i] = source.raw_sensor_data[i];
@@ -81,21 +108,18 @@ namespace ommo::api {
         new_data->battery_state = source.battery_state;
 
         new_data->pose_count = source.pose_count;
-        new_data->poses = new PoseData[new_data->pose_count];
         for (int i = 0; i < new_data->pose_count; i++)
         {
             new_data->poses[i] = source.poses[i];
         }
 
         new_data->button_count = source.button_count;
-        new_data->buttons = new ButtonState[new_data->button_count];
         for (int i = 0; i < new_data->button_count; i++)
         {
             new_data->buttons[i] = source.buttons[i];
         }
 
         new_data->latency_timestamp_count = source.latency_timestamp_count;
-        new_data->latency_timestamps = new TimestampData[new_data->latency_timestamp_count];
         for (int i = 0; i < new_data->latency_timestamp_count; i++)
         {
             new_data->latency_timestamps[i] = source.latency_timestamps[i];
@@ -178,20 +202,13 @@ namespace ommo::api {
     void DestroyDeviceDescriptorMembers(DeviceDescriptor& descriptor)
     {
         descriptor.sensor_unit_descriptor_count = 0;
-        delete[] descriptor.sensor_unit_descriptors;
-        descriptor.sensor_unit_descriptors = nullptr;
-
         descriptor.supported_fusion_modes_count = 0;
-        delete[] descriptor.supported_fusion_modes;
-        descriptor.supported_fusion_modes = nullptr;
+        ommo::DeletePooledArrayBlock(descriptor.sensor_unit_descriptors, descriptor.supported_fusion_modes);
     }
 
     void DestroyCommonHardwareStateMembers(CommonHardwareState& state)
     {
-        delete[] state.serial_number;
-        state.serial_number = nullptr;
-        delete[] state.usb_port_name;
-        state.usb_port_name = nullptr;
+        ommo::DeletePooledArrayBlock(state.serial_number, state.usb_port_name);
     }
 
     void DestroyBasestationHardwareStateMembers(BasestationHardwareState& state)
@@ -203,7 +220,7 @@ namespace ommo::api {
     {
         DestroyCommonHardwareStateMembers(state.common_state);
         state.sensor_device_state_count = 0;
-        delete[] state.sensor_device_states;
+        ommo::DeletePooledArray(state.sensor_device_states);
         state.sensor_device_states = nullptr;
     }
 
@@ -211,27 +228,17 @@ namespace ommo::api {
     {
         DestroyCommonHardwareStateMembers(state.common_state);
         state.connected_siu_count = 0;
-        delete[] state.connected_sius;
+        ommo::DeletePooledArray(state.connected_sius);
         state.connected_sius = nullptr;
     }
 
     void DestroyTrackingDeviceDataMembers(TrackingDeviceData& data)
     {
         data.raw_sensor_data_count = 0;
-        delete[] data.raw_sensor_data;
-        data.raw_sensor_data = nullptr;
-
         data.pose_count = 0;
-        delete[] data.poses;
-        data.poses = nullptr;
-
         data.button_count = 0;
-        delete[] data.buttons;
-        data.buttons = nullptr;
-
         data.latency_timestamp_count = 0;
-        delete[] data.latency_timestamps;
-        data.latency_timestamps = nullptr;
+        ommo::DeletePooledArrayBlock(data.raw_sensor_data, data.poses, data.buttons, data.latency_timestamps);
     }
 
     void DestroyDevicePacketMembers(DevicePacket& packet)
@@ -339,19 +346,19 @@ namespace ommo::api {
         {
             DestroyBasestationHardwareStateMembers(states->basestation_states[i]);
         }
-        delete[] states->basestation_states;
+        ommo::DeletePooledArray(states->basestation_states);
 
         for (uint32_t i = 0; i < states->siu_state_count; i++)
         {
             DestroySIUHardwareStateMembers(states->siu_states[i]);
         }
-        delete[] states->siu_states;
+        ommo::DeletePooledArray(states->siu_states);
 
         for (uint32_t i = 0; i < states->wireless_receiver_state_count; i++)
         {
             DestroyWirelessReceiverHardwareStateMembers(states->wireless_receiver_states[i]);
         }
-        delete[] states->wireless_receiver_states;
+        ommo::DeletePooledArray(states->wireless_receiver_states);
 
         delete states;
     }
@@ -372,7 +379,7 @@ namespace ommo::api {
         {
             DestroyTrackingDeviceDataMembers(data_frame->device_data[i]);
         }
-        delete[] data_frame->device_data;
+        ommo::DeletePooledArray(data_frame->device_data);
 
         delete data_frame;
     }
@@ -393,10 +400,41 @@ namespace ommo::api {
         {
             DestroyDevicePacketMembers(response->packets[i]);
         }
-        delete[] response->packets;
+        ommo::DeletePooledArray(response->packets);
         delete response;
     }
 
+    void DestroyDataView(DataView* view)
+    {
+        if (view == nullptr) return;
+
+        // The packets are borrowed from the storage, only the guard is owned by the view
+        delete static_cast<ommo::DataViewGuard*>(view->guard);
+        delete view;
+    }
+
+    void DestroyDevicePacketBuffer(DevicePacketBuffer* buffer)
+    {
+        if (buffer == nullptr) return;
+
+        // Member arrays are allocated for every packet up to the capacity, not only the filled ones
+        for (uint32_t i = 0; i < buffer->packet_capacity; i++)
+        {
+            DestroyDevicePacketMembers(buffer->packets[i]);
+        }
+        ommo::DeletePooledArray(buffer->packets);
+        delete buffer;
+    }
+
+    void DestroyHistoryView(HistoryView* view)
+    {
+        if (view == nullptr) return;
+
+        // The columns are borrowed from the storage, only the guard is owned by the view
+        delete static_cast<ommo::DataViewGuard*>(view->guard);
+        delete view;
+    }
+
     void DestroyBaseStationDataResponse(BaseStationDataResponse* response)
     {
         if (response == nullptr) return;
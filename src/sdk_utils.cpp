@@ -7,6 +7,7 @@
 */
 
 #include "sdk_utils.h"
+#include "device_data_storage.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -17,25 +18,25 @@ namespace ommo::api
     uint64_t Hash(const DeviceDescriptor& r)
     {
         uint64_t hash = r.siu_uuid;
-        return (hash << 8) | r.port_id;
+        return (hash << 32) | r.port_id;
     }
 
     uint64_t Hash(const TrackingDeviceData& r)
     {
         uint64_t hash = r.siu_uuid;
-        return (hash << 8) | r.port_id;
+        return (hash << 32) | r.port_id;
     }
 
     uint64_t Hash(const DeviceID& r)
     {
         uint64_t hash = r.siu_uuid;
-        return (hash << 8) | r.port_id;
+        return (hash << 32) | r.port_id;
     }
 
     uint64_t Hash(uint32_t siu_uuid, uint32_t port_id)
     {
         uint64_t hash = siu_uuid;
-        return (hash << 8) | port_id;
+        return (hash << 32) | port_id;
     }
 
     bool SystemTimeToString(uint64_t milliseconds, char* buffer, size_t buffer_size)
@@ -133,4 +134,25 @@ namespace ommo::api
         return (result == (buffer_size_min - 1));
     }
 
+    bool IsDataViewValid(const DataView& view)
+    {
+        const ommo::DataViewGuard* guard = static_cast<const ommo::DataViewGuard*>(view.guard);
+        if (guard == nullptr || guard->storage == nullptr)
+        {
+            // Views without storage have no packets that could be overwritten
+            return true;
+        }
+        return guard->storage->IsViewValid(guard->first_position, guard->packet_count);
+    }
+
+    bool IsHistoryViewValid(const HistoryView& view)
+    {
+        const ommo::DataViewGuard* guard = static_cast<const ommo::DataViewGuard*>(view.guard);
+        if (guard == nullptr || guard->storage == nullptr)
+        {
+            return true;
+        }
+        return guard->storage->IsViewValid(guard->first_position, guard->packet_count);
+    }
+
 }  // namespace ommo::api
\ No newline at end of file
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#include "shared_device_data_stream.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "data_manager.h"
+#include "logger_base.h"
+#include "protobuf_converters.h"
+#include "sdk_utils.h"
+#include "wire_decoder.h"
+
+namespace ommo
+{
+
+    bool DeviceDataStreamKey::operator==(const DeviceDataStreamKey& other) const
+    {
+        return siu_uuid == other.siu_uuid && port_id == other.port_id && field_mask == other.field_mask && fusion_mode == other.fusion_mode &&
+            include_raw_sensor_data == other.include_raw_sensor_data && report_interval == other.report_interval && buffer_depth == other.buffer_depth;
+    }
+
+    size_t DeviceDataStreamKeyHash::operator()(const DeviceDataStreamKey& key) const
+    {
+        size_t hash = std::hash<uint64_t>()(api::Hash(key.siu_uuid, key.port_id));
+        for (uint32_t value : { key.field_mask, static_cast<uint32_t>(key.fusion_mode), static_cast<uint32_t>(key.include_raw_sensor_data), key.report_interval, key.buffer_depth })
+        {
+            hash ^= std::hash<uint32_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    SharedDeviceDataStream::SharedDeviceDataStream(const DeviceDataStreamKey& key) : key_(key), subscribers_(std::make_shared<const SubscriberList>())
+    {
+    }
+
+    const DeviceDataStreamKey& SharedDeviceDataStream::GetKey() const
+    {
+        return key_;
+    }
+
+    void SharedDeviceDataStream::SetCallData(rpcClientCallData* call_data)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        call_data_ = call_data;
+    }
+
+    bool SharedDeviceDataStream::AddSubscriber(const std::shared_ptr<DataManager>& data_manager)
+    {
+        std::shared_ptr<DeviceStorageSlot> slot = data_manager->GetStorageSlot(api::Hash(key_.siu_uuid, key_.port_id));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ended_)
+        {
+            return false;
+        }
+
+        auto subscribers = std::make_shared<SubscriberList>(*std::atomic_load(&subscribers_));
+        subscribers->push_back(Subscriber{ data_manager, std::move(slot) });
+        std::atomic_store(&subscribers_, std::shared_ptr<const SubscriberList>(std::move(subscribers)));
+        return true;
+    }
+
+    void SharedDeviceDataStream::RemoveSubscriber(const DataManager* data_manager)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto subscribers = std::make_shared<SubscriberList>(*std::atomic_load(&subscribers_));
+        subscribers->erase(std::remove_if(subscribers->begin(), subscribers->end(), [data_manager](const Subscriber& subscriber) { return subscriber.data_manager.get() == data_manager; }), subscribers->end());
+        const bool last_subscriber = subscribers->empty();
+        std::atomic_store(&subscribers_, std::shared_ptr<const SubscriberList>(std::move(subscribers)));
+
+        // The completion queue deletes the call data once it is cancelled
+        if (last_subscriber && !ended_)
+        {
+            ended_ = true;
+            if (call_data_)
+            {
+                call_data_->CancelCall();
+            }
+        }
+    }
+
+    void SharedDeviceDataStream::Publish(const ommo::TrackingDeviceData& packet)
+    {
+        std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&subscribers_);
+        if (subscribers->size() == 1)
+        {
+            // A single subscriber converts the packet itself, straight into its storage if it has no callback
+            subscribers->front().data_manager->UpdateDeviceData(packet, *subscribers->front().slot);
+            return;
+        }
+        if (subscribers->empty())
+        {
+            return;
+        }
+
+        // Subscribers share the stream key, so they all requested the same parts
+        const api::TrackingDeviceDataSPtr converted = ProtoToSharedTrackingDeviceData(packet, RequestedDeviceDataParts(key_.field_mask, key_.include_raw_sensor_data));
+        for (const Subscriber& subscriber : *subscribers)
+        {
+            subscriber.data_manager->UpdateDeviceData(converted, *subscriber.slot);
+        }
+    }
+
+    void SharedDeviceDataStream::Publish(const uint8_t* data, size_t size)
+    {
+        std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&subscribers_);
+        if (subscribers->size() == 1)
+        {
+            // A single subscriber decodes the bytes itself, straight into its storage if it has no callback
+            subscribers->front().data_manager->UpdateDeviceData(data, size, *subscribers->front().slot);
+            return;
+        }
+        if (subscribers->empty())
+        {
+            return;
+        }
+
+        const api::TrackingDeviceDataSPtr decoded = DecodeSharedTrackingDeviceData(data, size, RequestedDeviceDataParts(key_.field_mask, key_.include_raw_sensor_data));
+        if (!decoded)
+        {
+            OMMOLOG_WARN("Dropping malformed TrackingDeviceData.");
+            return;
+        }
+        for (const Subscriber& subscriber : *subscribers)
+        {
+            subscriber.data_manager->UpdateDeviceData(decoded, *subscriber.slot);
+        }
+    }
+
+    bool SharedDeviceDataStream::ClearAssociation(void* call_data_ptr)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (call_data_ != static_cast<rpcClientCallData*>(call_data_ptr))
+        {
+            return false;
+        }
+        call_data_ = nullptr;
+        ended_ = true;
+        std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&subscribers_);
+        lock.unlock();
+
+        // The stream ended on its own, let the subscribers open a new one on the next device event
+        for (const Subscriber& subscriber : *subscribers)
+        {
+            subscriber.data_manager->RemoveStream(this);
+        }
+        return true;
+    }
+
+}  // namespace ommo
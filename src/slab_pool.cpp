@@ -0,0 +1,365 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#include "slab_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace
+{
+    // Size classes are powers of two from 64 bytes to 64KiB
+    constexpr size_t min_class_shift = 6;
+    constexpr size_t class_count = 11;
+    constexpr size_t max_class_size = size_t{ 1 } << (min_class_shift + class_count - 1);
+
+    // Every block starts with a header holding its size. Keeps the payload aligned like operator new.
+    constexpr size_t header_size = std::max<size_t>(alignof(std::max_align_t), 16);
+    constexpr uint32_t large_class = UINT32_MAX;
+
+    // Marks a block handed out by the pool, cleared when the block is freed
+    constexpr uint32_t block_magic = 0x5ab1b10c;
+
+    // Size of a slab carved into blocks, and of the batches moved between the thread and shared free lists.
+    // Slabs and large blocks are aligned to the slab size, see ChunkMap.
+    constexpr size_t slab_shift = 18;
+    constexpr size_t slab_size = size_t{ 1 } << slab_shift;
+    constexpr size_t batch_bytes = 32 * 1024;
+
+    struct BlockHeader
+    {
+        size_t size;
+        uint32_t size_class;
+        uint32_t magic;
+    };
+    static_assert(sizeof(BlockHeader) <= header_size, "Block header must fit in front of the payload");
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    size_t ClassSize(size_t size_class)
+    {
+        return size_t{ 1 } << (min_class_shift + size_class);
+    }
+
+    size_t BlockSize(size_t size_class)
+    {
+        return header_size + ClassSize(size_class);
+    }
+
+    size_t BatchCount(size_t size_class)
+    {
+        return std::max<size_t>(1, batch_bytes / BlockSize(size_class));
+    }
+
+    size_t SizeClass(size_t size)
+    {
+        size_t size_class = 0;
+        while (ClassSize(size_class) < size)
+        {
+            size_class++;
+        }
+        return size_class;
+    }
+
+    /*
+     * Marks the slab sized chunks of the address space that start with pool memory: the slabs, and the first chunk of
+     * every large block. A header is only read when the block start of a pointer lies in a marked chunk, so memory from
+     * elsewhere, e.g. an array the application allocated with new[], is recognized without touching it.
+     *
+     * A three level radix tree over the chunk number. The inner levels are added on first use and never freed, lookups
+     * do not lock. Zero initialized and trivially destructible, so it is usable before main and while the process exits.
+     */
+    class ChunkMap
+    {
+    public:
+        void Mark(const void* chunk, bool used)
+        {
+            const uint64_t key = Key(chunk);
+            Mid* mid = GetOrAdd(top_[key >> (mid_bits + leaf_bits)]);
+            Leaf* leaf = GetOrAdd(mid->leaves[(key >> leaf_bits) & ((size_t{ 1 } << mid_bits) - 1)]);
+            std::atomic<uint64_t>& word = leaf->words[(key & ((size_t{ 1 } << leaf_bits) - 1)) / 64];
+            const uint64_t bit = uint64_t{ 1 } << (key % 64);
+            if (used)
+            {
+                word.fetch_or(bit, std::memory_order_release);
+            }
+            else
+            {
+                word.fetch_and(~bit, std::memory_order_release);
+            }
+        }
+
+        bool IsMarked(const void* address) const
+        {
+            const uint64_t key = Key(address);
+            const Mid* mid = top_[key >> (mid_bits + leaf_bits)].load(std::memory_order_acquire);
+            if (mid == nullptr)
+            {
+                return false;
+            }
+            const Leaf* leaf = mid->leaves[(key >> leaf_bits) & ((size_t{ 1 } << mid_bits) - 1)].load(std::memory_order_acquire);
+            if (leaf == nullptr)
+            {
+                return false;
+            }
+            const uint64_t word = leaf->words[(key & ((size_t{ 1 } << leaf_bits) - 1)) / 64].load(std::memory_order_acquire);
+            return (word & (uint64_t{ 1 } << (key % 64))) != 0;
+        }
+
+    private:
+        static constexpr size_t leaf_bits = 15;
+        static constexpr size_t mid_bits = 15;
+        static constexpr size_t top_bits = 64 - slab_shift - mid_bits - leaf_bits;
+
+        struct Leaf
+        {
+            std::atomic<uint64_t> words[(size_t{ 1 } << leaf_bits) / 64];
+        };
+
+        struct Mid
+        {
+            std::atomic<Leaf*> leaves[size_t{ 1 } << mid_bits];
+        };
+
+        static uint64_t Key(const void* address)
+        {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address)) >> slab_shift;
+        }
+
+        template <typename T>
+        static T* GetOrAdd(std::atomic<T*>& slot)
+        {
+            T* node = slot.load(std::memory_order_acquire);
+            if (node != nullptr)
+            {
+                return node;
+            }
+            T* added = new T();
+            if (slot.compare_exchange_strong(node, added, std::memory_order_acq_rel))
+            {
+                return added;
+            }
+            delete added;
+            return node;
+        }
+
+        std::atomic<Mid*> top_[size_t{ 1 } << top_bits];
+    };
+
+    ChunkMap chunk_map;
+
+    void* AllocateChunkAligned(size_t size)
+    {
+        void* memory = ::operator new(size, std::align_val_t{ slab_size });
+        chunk_map.Mark(memory, true);
+        return memory;
+    }
+
+    void FreeChunkAligned(void* memory)
+    {
+        chunk_map.Mark(memory, false);
+        ::operator delete(memory, std::align_val_t{ slab_size });
+    }
+
+    // Header of a pointer returned by SlabPoolAllocate, nullptr if the pointer did not come from the pool
+    BlockHeader* FindHeader(const void* memory)
+    {
+        const uintptr_t block = reinterpret_cast<uintptr_t>(memory) - header_size;
+        if (memory == nullptr || !chunk_map.IsMarked(reinterpret_cast<const void*>(block)))
+        {
+            return nullptr;
+        }
+
+        // The chunk belongs to the pool, so the header can be read. Pointers into the middle of a block, or to a block
+        // that was freed, are rejected by the offset and the marker.
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+        const uintptr_t offset = block & (slab_size - 1);
+        const bool aligned = header->size_class == large_class ? offset == 0 :
+            header->size_class < class_count && offset % BlockSize(header->size_class) == 0;
+        return aligned && header->magic == block_magic ? header : nullptr;
+    }
+
+    // Shared free list of a size class. The slabs its blocks were carved from are never freed.
+    struct SharedPool
+    {
+        std::mutex mutex;
+        FreeBlock* free = nullptr;
+    };
+
+    // Never destroyed, threads may still return blocks while the process exits
+    SharedPool* SharedPools()
+    {
+        static SharedPool* pools = new SharedPool[class_count];
+        return pools;
+    }
+
+    // Move up to <count> blocks from <list> to the front of <destination>. Returns the number of moved blocks.
+    size_t MoveBlocks(FreeBlock*& list, FreeBlock*& destination, size_t count)
+    {
+        size_t moved = 0;
+        while (list != nullptr && moved < count)
+        {
+            FreeBlock* block = list;
+            list = block->next;
+            block->next = destination;
+            destination = block;
+            moved++;
+        }
+        return moved;
+    }
+
+    // Take up to <count> blocks of a size class from the shared pool, carving a new slab if it has none left
+    size_t TakeSharedBlocks(size_t size_class, FreeBlock*& destination, size_t count)
+    {
+        SharedPool& pool = SharedPools()[size_class];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.free == nullptr)
+        {
+            const size_t block_size = BlockSize(size_class);
+            const size_t block_count = std::max<size_t>(1, slab_size / block_size);
+            char* slab = static_cast<char*>(AllocateChunkAligned(slab_size));
+            for (size_t i = 0; i < block_count; i++)
+            {
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * block_size);
+                block->next = pool.free;
+                pool.free = block;
+            }
+        }
+        return MoveBlocks(pool.free, destination, count);
+    }
+
+    void ReturnSharedBlocks(size_t size_class, FreeBlock*& list, size_t count)
+    {
+        SharedPool& pool = SharedPools()[size_class];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        MoveBlocks(list, pool.free, count);
+    }
+
+    // Free lists of a thread. Handed back to the shared pools when the thread exits.
+    struct ThreadCache
+    {
+        FreeBlock* free[class_count] = {};
+        size_t count[class_count] = {};
+
+        ~ThreadCache();
+    };
+
+    // Trivially destructible, so it can still be checked after the cache of the thread was destroyed
+    thread_local bool thread_cache_destroyed = false;
+    thread_local ThreadCache thread_cache;
+
+    ThreadCache::~ThreadCache()
+    {
+        for (size_t size_class = 0; size_class < class_count; size_class++)
+        {
+            ReturnSharedBlocks(size_class, free[size_class], count[size_class]);
+            count[size_class] = 0;
+        }
+        thread_cache_destroyed = true;
+    }
+
+    FreeBlock* AllocateBlock(size_t size_class)
+    {
+        FreeBlock* block = nullptr;
+        if (thread_cache_destroyed)
+        {
+            // Allocating while the thread exits, bypass the thread cache
+            TakeSharedBlocks(size_class, block, 1);
+            return block;
+        }
+
+        ThreadCache& cache = thread_cache;
+        if (cache.free[size_class] == nullptr)
+        {
+            cache.count[size_class] += TakeSharedBlocks(size_class, cache.free[size_class], BatchCount(size_class));
+        }
+        block = cache.free[size_class];
+        cache.free[size_class] = block->next;
+        cache.count[size_class]--;
+        return block;
+    }
+
+    void FreeBlockToPool(FreeBlock* block, size_t size_class)
+    {
+        if (thread_cache_destroyed)
+        {
+            block->next = nullptr;
+            ReturnSharedBlocks(size_class, block, 1);
+            return;
+        }
+
+        ThreadCache& cache = thread_cache;
+        block->next = cache.free[size_class];
+        cache.free[size_class] = block;
+        cache.count[size_class]++;
+
+        // Keep at most two batches per thread so blocks freed on a consumer thread flow back to the producers
+        const size_t batch_count = BatchCount(size_class);
+        if (cache.count[size_class] > 2 * batch_count)
+        {
+            ReturnSharedBlocks(size_class, cache.free[size_class], batch_count);
+            cache.count[size_class] -= batch_count;
+        }
+    }
+}
+
+namespace ommo
+{
+
+    void* SlabPoolAllocate(size_t size)
+    {
+        BlockHeader* header;
+        if (size > max_class_size)
+        {
+            header = static_cast<BlockHeader*>(AllocateChunkAligned(header_size + size));
+            header->size = size;
+            header->size_class = large_class;
+        }
+        else
+        {
+            const size_t size_class = SizeClass(size);
+            header = reinterpret_cast<BlockHeader*>(AllocateBlock(size_class));
+            header->size = ClassSize(size_class);
+            header->size_class = static_cast<uint32_t>(size_class);
+        }
+
+        header->magic = block_magic;
+        return reinterpret_cast<char*>(header) + header_size;
+    }
+
+    size_t SlabPoolBlockSize(const void* memory)
+    {
+        const BlockHeader* header = FindHeader(memory);
+        return header == nullptr ? 0 : header->size;
+    }
+
+    bool SlabPoolFree(void* memory)
+    {
+        BlockHeader* header = FindHeader(memory);
+        if (header == nullptr)
+        {
+            return false;
+        }
+
+        header->magic = 0;
+        if (header->size_class == large_class)
+        {
+            FreeChunkAligned(header);
+            return true;
+        }
+        FreeBlockToPool(reinterpret_cast<FreeBlock*>(header), header->size_class);
+        return true;
+    }
+
+}  // namespace ommo
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+ */
+
+#include "unary_call_registry.h"
+
+namespace ommo
+{
+    bool UnaryCallRegistry::StartCall(const std::function<rpcClientCallData*()>& start_call)
+    {
+        // Start the call under the lock, so Stop either sees it registered or it is never started. A call completing
+        // right away waits in ClearAssociation until it is registered.
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_)
+        {
+            return false;
+        }
+        calls_.insert(start_call());
+        return true;
+    }
+
+    void UnaryCallRegistry::Stop()
+    {
+        // Holding the lock keeps the calls from being deleted while they are cancelled
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        for (rpcClientCallData* call_data : calls_)
+        {
+            call_data->CancelCall();
+        }
+    }
+
+    bool UnaryCallRegistry::ClearAssociation(void* call_data_ptr)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return calls_.erase(static_cast<rpcClientCallData*>(call_data_ptr)) > 0;
+    }
+}  // namespace ommo
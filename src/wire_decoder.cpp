@@ -0,0 +1,455 @@
+/*
+ * Copyright 2025 Ommo Technologies, Inc. - All Rights Reserved
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+ * OF ANY KIND, either express or implied.
+*/
+
+#include "wire_decoder.h"
+
+#include <algorithm>
+
+#include "api_member_blocks.h"
+
+namespace
+{
+    using ommo::WireReader;
+
+    // Field numbers of ommo::TrackingDeviceData
+    enum DeviceDataField : uint32_t
+    {
+        kSiuUuid = 1,
+        kPortId = 2,
+        kBasestationAngle = 3,
+        kBasestationSpeed = 4,
+        kTimestamp = 5,
+        kRawSensorData = 7,
+        kPositions = 8,
+        kQuaternions = 9,
+        kIndicatorValues = 10,
+        kButtons = 11,
+        kMotionIndicators = 12,
+        kBadDataIndicators = 13,
+        kLatencyTimestamps = 14,
+        kBatteryState = 15
+    };
+
+    int32_t ZigZagDecode(uint64_t value)
+    {
+        const uint32_t bits = static_cast<uint32_t>(value);
+        return static_cast<int32_t>((bits >> 1) ^ (~(bits & 1) + 1));
+    }
+
+    // Read a varint field that must have the varint wire type
+    bool ReadVarintField(WireReader& reader, uint32_t wire_type, uint64_t& value)
+    {
+        return wire_type == WireReader::kVarint && reader.ReadVarint(value);
+    }
+
+    // Read a float field that must have the fixed32 wire type
+    bool ReadFloatField(WireReader& reader, uint32_t wire_type, float& value)
+    {
+        return wire_type == WireReader::kFixed32 && reader.ReadFloat(value);
+    }
+
+    // Read a sub-message field into a reader over its bytes
+    bool ReadMessageField(WireReader& reader, uint32_t wire_type, WireReader& message)
+    {
+        return wire_type == WireReader::kLengthDelimited && reader.ReadLengthDelimited(message);
+    }
+
+    // Decode a message by calling <decode_field> for each field. Returns false if the message is malformed.
+    template <typename FieldDecoder>
+    bool DecodeMessage(WireReader reader, FieldDecoder&& decode_field)
+    {
+        uint32_t field_number;
+        uint32_t wire_type;
+        while (reader.ReadTag(field_number, wire_type))
+        {
+            if (!decode_field(reader, field_number, wire_type))
+            {
+                return false;
+            }
+        }
+        return reader.AtEnd();
+    }
+
+    bool DecodeVector3i(WireReader message, ommo::api::Vector3i& vector)
+    {
+        return DecodeMessage(message, [&vector](WireReader& reader, uint32_t field_number, uint32_t wire_type)
+        {
+            uint64_t value;
+            int32_t* component = field_number == 1 ? &vector.x : field_number == 2 ? &vector.y : field_number == 3 ? &vector.z : nullptr;
+            if (component == nullptr)
+            {
+                return reader.Skip(wire_type);
+            }
+            if (!ReadVarintField(reader, wire_type, value))
+            {
+                return false;
+            }
+            *component = ZigZagDecode(value);
+            return true;
+        });
+    }
+
+    bool DecodeRawSensorData(WireReader message, ommo::api::RawSensorData& raw_sensor_data)
+    {
+        return DecodeMessage(message, [&raw_sensor_data](WireReader& reader, uint32_t field_number, uint32_t wire_type)
+        {
+            ommo::api::Vector3i* vector = field_number == 1 ? &raw_sensor_data.mag : field_number == 2 ? &raw_sensor_data.gyro : field_number == 3 ? &raw_sensor_data.accel : nullptr;
+            if (vector == nullptr)
+            {
+                return reader.Skip(wire_type);
+            }
+            WireReader vector_message(nullptr, 0);
+            return ReadMessageField(reader, wire_type, vector_message) && DecodeVector3i(vector_message, *vector);
+        });
+    }
+
+    // Decode a message with float fields numbered 1 to <count> into <components>
+    bool DecodeFloatVector(WireReader message, float* const* components, uint32_t count)
+    {
+        return DecodeMessage(message, [components, count](WireReader& reader, uint32_t field_number, uint32_t wire_type)
+        {
+            if (field_number < 1 || field_number > count)
+            {
+                return reader.Skip(wire_type);
+            }
+            return ReadFloatField(reader, wire_type, *components[field_number - 1]);
+        });
+    }
+
+    bool DecodeLatencyTimestamp(WireReader message, ommo::api::TimestampData& timestamp)
+    {
+        return DecodeMessage(message, [&timestamp](WireReader& reader, uint32_t field_number, uint32_t wire_type)
+        {
+            uint64_t value;
+            switch (field_number)
+            {
+            case 1:
+                if (!ReadVarintField(reader, wire_type, value))
+                {
+                    return false;
+                }
+                timestamp.timestamp_type = static_cast<ommo::api::TimestampType>(value);
+                return true;
+            case 2:
+                return ReadVarintField(reader, wire_type, timestamp.steady_timestamp_milliseconds);
+            case 3:
+                return ReadVarintField(reader, wire_type, timestamp.system_timestamp_milliseconds);
+            default:
+                return reader.Skip(wire_type);
+            }
+        });
+    }
+
+    bool DecodeBatteryState(WireReader message, ommo::api::BatteryState& battery_state)
+    {
+        return DecodeMessage(message, [&battery_state](WireReader& reader, uint32_t field_number, uint32_t wire_type)
+        {
+            uint64_t value;
+            int32_t* field = field_number == 1 ? &battery_state.state_of_charge : field_number == 2 ? &battery_state.current : field_number == 3 ? &battery_state.remaining_capacity : nullptr;
+            if (field == nullptr)
+            {
+                return reader.Skip(wire_type);
+            }
+            if (!ReadVarintField(reader, wire_type, value))
+            {
+                return false;
+            }
+            // Negative int32 values are sign extended to 64 bit on the wire
+            *field = static_cast<int32_t>(value);
+            return true;
+        });
+    }
+
+    // Decode a repeated float field, which may be packed or not. Values beyond <capacity> are dropped.
+    bool DecodeRepeatedFloat(WireReader& reader, uint32_t wire_type, ommo::api::PoseData* poses, uint32_t capacity, float ommo::api::PoseData::* member, uint32_t& count)
+    {
+        float value;
+        if (wire_type == WireReader::kLengthDelimited)
+        {
+            WireReader packed(nullptr, 0);
+            if (!reader.ReadLengthDelimited(packed))
+            {
+                return false;
+            }
+            while (!packed.AtEnd())
+            {
+                if (!packed.ReadFloat(value))
+                {
+                    return false;
+                }
+                if (count < capacity)
+                {
+                    poses[count].*member = value;
+                }
+                count++;
+            }
+            return true;
+        }
+
+        if (!ReadFloatField(reader, wire_type, value))
+        {
+            return false;
+        }
+        if (count < capacity)
+        {
+            poses[count].*member = value;
+        }
+        count++;
+        return true;
+    }
+
+    // Decode a repeated enum field, which may be packed or not. Calls <store> for every value.
+    template <typename Store>
+    bool DecodeRepeatedVarint(WireReader& reader, uint32_t wire_type, Store&& store)
+    {
+        uint64_t value;
+        if (wire_type == WireReader::kLengthDelimited)
+        {
+            WireReader packed(nullptr, 0);
+            if (!reader.ReadLengthDelimited(packed))
+            {
+                return false;
+            }
+            while (!packed.AtEnd())
+            {
+                if (!packed.ReadVarint(value))
+                {
+                    return false;
+                }
+                store(value);
+            }
+            return true;
+        }
+
+        if (!ReadVarintField(reader, wire_type, value))
+        {
+            return false;
+        }
+        store(value);
+        return true;
+    }
+}
+
+namespace ommo
+{
+
+    bool ScanEncodedDeviceData(const uint8_t* data, size_t size, EncodedDeviceDataLayout& layout, uint32_t parts)
+    {
+        layout = EncodedDeviceDataLayout{};
+        layout.parts = parts;
+        return DecodeMessage(WireReader(data, size), [&layout](WireReader& reader, uint32_t field_number, uint32_t wire_type)
+        {
+            uint64_t value;
+            switch (field_number)
+            {
+            case kSiuUuid:
+                if (!ReadVarintField(reader, wire_type, value))
+                {
+                    return false;
+                }
+                layout.siu_uuid = static_cast<uint32_t>(value);
+                return true;
+            case kPortId:
+                if (!ReadVarintField(reader, wire_type, value))
+                {
+                    return false;
+                }
+                layout.port_id = static_cast<uint32_t>(value);
+                return true;
+            case kTimestamp:
+                if (!ReadVarintField(reader, wire_type, value))
+                {
+                    return false;
+                }
+                layout.timestamp = static_cast<uint32_t>(value);
+                return true;
+            case kRawSensorData:
+                if ((layout.parts & kDeviceDataRawSensorData) != 0)
+                {
+                    layout.raw_sensor_data_count++;
+                }
+                return reader.Skip(wire_type);
+            case kPositions:
+                layout.pose_count++;
+                return reader.Skip(wire_type);
+            case kButtons:
+                if ((layout.parts & kDeviceDataButtons) == 0)
+                {
+                    return reader.Skip(wire_type);
+                }
+                return DecodeRepeatedVarint(reader, wire_type, [&layout](uint64_t) { layout.button_count++; });
+            case kLatencyTimestamps:
+            {
+                WireReader message(nullptr, 0);
+                api::TimestampData timestamp{};
+                if (!ReadMessageField(reader, wire_type, message) || !DecodeLatencyTimestamp(message, timestamp))
+                {
+                    return false;
+                }
+                layout.latency_timestamp_count++;
+                if (timestamp.timestamp_type == api::TimestampType::kTimestampTypeSample)
+                {
+                    layout.sample_time = std::max(layout.sample_time, timestamp.steady_timestamp_milliseconds);
+                }
+                return true;
+            }
+            default:
+                return reader.Skip(wire_type);
+            }
+        });
+    }
+
+    bool DecodeEncodedDeviceData(const uint8_t* data, size_t size, const EncodedDeviceDataLayout& layout, api::TrackingDeviceData& device_data)
+    {
+        device_data.siu_uuid = layout.siu_uuid;
+        device_data.port_id = layout.port_id;
+        device_data.basestation_angle = 0;
+        device_data.basestation_speed = 0;
+        device_data.timestamp = 0;
+        device_data.raw_sensor_data_count = layout.raw_sensor_data_count;
+        device_data.pose_count = layout.pose_count;
+        device_data.button_count = layout.button_count;
+        device_data.latency_timestamp_count = layout.latency_timestamp_count;
+        // A packet without battery state reports -1 for all values
+        device_data.battery_state = api::BatteryState{ -1, -1, -1 };
+
+        // Fields missing from a message default to zero
+        std::fill_n(device_data.raw_sensor_data, layout.raw_sensor_data_count, api::RawSensorData{});
+        std::fill_n(device_data.poses, layout.pose_count, api::PoseData{});
+        std::fill_n(device_data.buttons, layout.button_count, api::ButtonState{});
+        std::fill_n(device_data.latency_timestamps, layout.latency_timestamp_count, api::TimestampData{});
+
+        uint32_t raw_sensor_data_count = 0;
+        uint32_t position_count = 0;
+        uint32_t quaternion_count = 0;
+        uint32_t indicator_value_count = 0;
+        uint32_t motion_indicator_count = 0;
+        uint32_t bad_data_indicator_count = 0;
+        uint32_t button_count = 0;
+        uint32_t latency_timestamp_count = 0;
+        bool has_battery_state = false;
+
+        return DecodeMessage(WireReader(data, size), [&](WireReader& reader, uint32_t field_number, uint32_t wire_type)
+        {
+            uint64_t value;
+            WireReader message(nullptr, 0);
+            switch (field_number)
+            {
+            case kBasestationAngle:
+            case kBasestationSpeed:
+            case kTimestamp:
+            {
+                if (!ReadVarintField(reader, wire_type, value))
+                {
+                    return false;
+                }
+                uint32_t& field = field_number == kBasestationAngle ? device_data.basestation_angle :
+                    field_number == kBasestationSpeed ? device_data.basestation_speed : device_data.timestamp;
+                field = static_cast<uint32_t>(value);
+                return true;
+            }
+            case kRawSensorData:
+                if ((layout.parts & kDeviceDataRawSensorData) == 0)
+                {
+                    return reader.Skip(wire_type);
+                }
+                // The layout was scanned from the same bytes, so the counts cannot exceed the arrays
+                return ReadMessageField(reader, wire_type, message) && raw_sensor_data_count < layout.raw_sensor_data_count &&
+                    DecodeRawSensorData(message, device_data.raw_sensor_data[raw_sensor_data_count++]);
+            case kPositions:
+            {
+                if (!ReadMessageField(reader, wire_type, message) || position_count >= layout.pose_count)
+                {
+                    return false;
+                }
+                api::Vector3f& position = device_data.poses[position_count++].position;
+                float* const components[] = { &position.x, &position.y, &position.z };
+                return DecodeFloatVector(message, components, 3);
+            }
+            case kQuaternions:
+            {
+                if (!ReadMessageField(reader, wire_type, message))
+                {
+                    return false;
+                }
+                if (quaternion_count >= layout.pose_count)
+                {
+                    // More quaternions than positions. Ignored like the converters do.
+                    quaternion_count++;
+                    return true;
+                }
+                api::Vector4f& quaternion = device_data.poses[quaternion_count++].quaternion;
+                float* const components[] = { &quaternion.w, &quaternion.x, &quaternion.y, &quaternion.z };
+                return DecodeFloatVector(message, components, 4);
+            }
+            case kIndicatorValues:
+                return DecodeRepeatedFloat(reader, wire_type, device_data.poses, layout.pose_count, &api::PoseData::indicator_value, indicator_value_count);
+            case kMotionIndicators:
+                return DecodeRepeatedFloat(reader, wire_type, device_data.poses, layout.pose_count, &api::PoseData::motion_indicator, motion_indicator_count);
+            case kBadDataIndicators:
+                return DecodeRepeatedFloat(reader, wire_type, device_data.poses, layout.pose_count, &api::PoseData::bad_data_indicator, bad_data_indicator_count);
+            case kButtons:
+                if ((layout.parts & kDeviceDataButtons) == 0)
+                {
+                    return reader.Skip(wire_type);
+                }
+                return DecodeRepeatedVarint(reader, wire_type, [&](uint64_t button)
+                {
+                    if (button_count < layout.button_count)
+                    {
+                        device_data.buttons[button_count++] = static_cast<api::ButtonState>(button);
+                    }
+                });
+            case kLatencyTimestamps:
+                return ReadMessageField(reader, wire_type, message) && latency_timestamp_count < layout.latency_timestamp_count &&
+                    DecodeLatencyTimestamp(message, device_data.latency_timestamps[latency_timestamp_count++]);
+            case kBatteryState:
+                if ((layout.parts & kDeviceDataBatteryState) == 0)
+                {
+                    return reader.Skip(wire_type);
+                }
+                if (!ReadMessageField(reader, wire_type, message))
+                {
+                    return false;
+                }
+                // A present battery state defaults its missing values to zero. Repeated occurrences are merged.
+                if (!has_battery_state)
+                {
+                    device_data.battery_state = api::BatteryState{ 0, 0, 0 };
+                    has_battery_state = true;
+                }
+                return DecodeBatteryState(message, device_data.battery_state);
+            default:
+                // siu_uuid and port_id were read by the scan
+                return reader.Skip(wire_type);
+            }
+        });
+    }
+
+    api::TrackingDeviceDataSPtr DecodeSharedTrackingDeviceData(const uint8_t* data, size_t size, uint32_t parts)
+    {
+        EncodedDeviceDataLayout layout;
+        if (!ScanEncodedDeviceData(data, size, layout, parts))
+        {
+            return nullptr;
+        }
+
+        // All member arrays share one block, like a converted packet
+        api::TrackingDeviceDataUPtr device_data(new api::TrackingDeviceData{});
+        PooledArrayBlock block;
+        ReserveTrackingDeviceDataMembers(block, layout.raw_sensor_data_count, layout.pose_count, layout.button_count, layout.latency_timestamp_count);
+        block.Allocate();
+        PlaceTrackingDeviceDataMembers(block, *device_data, layout.raw_sensor_data_count, layout.pose_count, layout.button_count, layout.latency_timestamp_count);
+        if (!DecodeEncodedDeviceData(data, size, layout, *device_data))
+        {
+            return nullptr;
+        }
+        return device_data;
+    }
+
+}  // namespace ommo